@@ -24,6 +24,14 @@ Usage:
 Options:
   -h, --help        Show this help message and exit.
   -m, --macro       Macros to pass to the UI (required: P, R)
+  --stats           Show performance statistics (toggle with F12).
+  --trace FILE      Record a Chrome trace to FILE on exit or SIGUSR1.
+  --max-connects N  Channels connecting at once (default 64, 0 for no limit).
+  --decoders N      Threads decoding PV updates (default 0, on the callback thread).
+  --headless        Record PV updates instead of showing the UI.
+  --format FMT      Headless output format, csv (default) or jsonl.
+  --output FILE     Headless output file (default stdout).
+  --max-rate HZ     Headless maximum updates per second for each PV.
 
 Examples:
     pvtui_asyn --macro "P=xxx:,R=asyn1"
@@ -49,6 +57,7 @@ int main(int argc, char *argv[]) {
     InputWidget tmot(app, "$(P)$(R).TMOT", PVPutType::Double);
     InputWidget tfil(app, "$(P)$(R).TFIL", PVPutType::String);
     InputWidget nowt(app, "$(P)$(R).NOWT", PVPutType::Integer);
+    // STAT and SEVR post whenever the alarm changes, unlike ERRS which carries it too
     VarWidget<PVEnum> stat(app, "$(P)$(R).STAT");
     VarWidget<PVEnum> sevr(app, "$(P)$(R).SEVR");
     VarWidget<std::string> tinp(app, "$(P)$(R).TINP");
@@ -101,12 +110,15 @@ int main(int argc, char *argv[]) {
         })
     });
 
+    // SEVR choices are in the order of AlarmSeverity
     auto sevr_color = [&]() -> Decorator{
-        if (sevr.value().choice.find("MAJOR") != std::string::npos) {
+        switch (static_cast<AlarmSeverity>(sevr.value().index)) {
+        case AlarmSeverity::Major:
+        case AlarmSeverity::Invalid:
             return EPICSColor::custom(sevr, color(Color::Red));
-        } else if (sevr.value().choice.find("WARN") != std::string::npos) {
+        case AlarmSeverity::Minor:
             return EPICSColor::custom(sevr, color(Color::Orange1));
-        } else {
+        default:
             return EPICSColor::readback(sevr);
         }
     };
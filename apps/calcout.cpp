@@ -20,6 +20,14 @@ Usage:
 Options:
   -h, --help        Show this help message and exit.
   -m, --macro       Macros to pass to the UI (required: P, C)
+  --stats           Show performance statistics (toggle with F12).
+  --trace FILE      Record a Chrome trace to FILE on exit or SIGUSR1.
+  --max-connects N  Channels connecting at once (default 64, 0 for no limit).
+  --decoders N      Threads decoding PV updates (default 0, on the callback thread).
+  --headless        Record PV updates instead of showing the UI.
+  --format FMT      Headless output format, csv (default) or jsonl.
+  --output FILE     Headless output file (default stdout).
+  --max-rate HZ     Headless maximum updates per second for each PV.
 
 Examples:
     pvtui_calcout --macro "P=xxx:,C=calcout1"
@@ -54,7 +62,8 @@ int main(int argc, char *argv[]) {
     InputWidget ocal(app, "$(P)$(C).OCAL", PVPutType::String);
     InputWidget out(app, "$(P)$(C).OUT", PVPutType::String);
     InputWidget flnk(app, "$(P)$(C).FLNK", PVPutType::String);
-    VarWidget<std::string> val(app, "$(P)$(C).VAL");
+    // VAL posts whenever the record's alarm changes, so its updates carry the current alarm
+    VarWidget<Monitored<std::string>> val(app, "$(P)$(C).VAL");
     VarWidget<std::string> oval(app, "$(P)$(C).OVAL");
     ChoiceWidget dopt(app, "$(P)$(C).DOPT", ChoiceStyle::Dropdown);
     ChoiceWidget ivoa(app, "$(P)$(C).IVOA", ChoiceStyle::Dropdown);
@@ -79,6 +88,19 @@ int main(int argc, char *argv[]) {
 	ivoa.component(), ivov.component(), out.component(), flnk.component(),
     });
 
+    // Colors the result by the alarm severity of the same update
+    auto val_color = [&]() -> Decorator {
+        switch (val.value().alarm.severity) {
+        case AlarmSeverity::Major:
+        case AlarmSeverity::Invalid:
+            return EPICSColor::custom(val, color(Color::Red));
+        case AlarmSeverity::Minor:
+            return EPICSColor::custom(val, color(Color::Orange1));
+        default:
+            return EPICSColor::readback(val);
+        }
+    };
+
     // Main renderer to define visual layout of components and elements
     auto main_renderer = Renderer(main_container, [&] {
         return vbox({
@@ -144,7 +166,7 @@ int main(int argc, char *argv[]) {
 		filler() | size(WIDTH, EQUAL, 2),
 		calc.component()->Render() | size(WIDTH, EQUAL, 32) | EPICSColor::edit(calc),
 		separatorEmpty(),
-		text("   " + val.value()) | EPICSColor::readback(val),
+		text("   " + val.value().value) | val_color(),
 	    }) | (dopt.value().index == 0 ? border : borderEmpty) | color(Color::Black),
 
 	    hbox({
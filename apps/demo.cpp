@@ -42,6 +42,9 @@ int main(int argc, char *argv[]) {
     ButtonWidget plus(app, P+"add1.PROC", " + ");
     ButtonWidget minus(app, P+"subtract1.PROC", " - ");
 
+    // Last minute of the float PV
+    StripChartWidget float1_history(app, P+"float", 60.0, Color::Blue);
+
     // ftxui container to define interactivity of components
     auto main_container = Container::Vertical({
         ftxui::Container::Vertical({
@@ -115,6 +118,13 @@ int main(int argc, char *argv[]) {
                 }) | size(WIDTH, EQUAL, 30),
             }),
 
+            separator() | color(Color::Black),
+            hbox({
+                text(P+"float (60 s)") | color(Color::Black) | size(WIDTH, EQUAL, 30),
+                separator() | color(Color::Black),
+                float1_history.render(122, 24),
+            }),
+
         }) | center | EPICSColor::background();
     });
 
@@ -23,6 +23,14 @@ Usage:
 Options:
   -h, --help        Show this help message and exit.
   -m, --macro       Macros to pass to the UI
+  --stats           Show performance statistics (toggle with F12).
+  --trace FILE      Record a Chrome trace to FILE on exit or SIGUSR1.
+  --max-connects N  Channels connecting at once (default 64, 0 for no limit).
+  --decoders N      Threads decoding PV updates (default 0, on the callback thread).
+  --headless        Record PV updates instead of showing the UI.
+  --format FMT      Headless output format, csv (default) or jsonl.
+  --output FILE     Headless output file (default stdout).
+  --max-rate HZ     Headless maximum updates per second for each PV.
 
 Examples:
     # Make a screen with a input and readack component for each given PV
@@ -38,8 +46,9 @@ For more details, visit: https://github.com/nmarks99/pvtui
 
 int main(int argc, char *argv[]) {
 
-    // Parse command line arguments and macros
-    pvtui::ArgParser args(argc, argv);
+    // Instantiate an App to manage the arguments, PVs, and screen
+    App app(argc, argv);
+    ArgParser &args = app.args;
 
     if (args.help(CLI_HELP_MSG)) return EXIT_SUCCESS;
 
@@ -74,16 +83,8 @@ int main(int argc, char *argv[]) {
 	rbv_pvs.push_back(rbv_pv_name);
     }
 
-    // Create the FTXUI screen. Interactive and uses the full terminal screen
-    auto screen = ScreenInteractive::Fullscreen();
-
-    // Instantiate EPICS PVA client
-    // Start CAClientFactory so we can see CA only PVs
-    epics::pvAccess::ca::CAClientFactory::start();
-    pvac::ClientProvider provider(args.provider);
-
     // PVGroup to manage all PVs for displays
-    PVGroup pvgroup(provider);
+    PVGroup &pvgroup = app.pvgroup;
 
     // Create input widgets for the set PVs and VarWidget<std::string> for the readback PVs
     // We use strings for everything here because it should work for most (all?) PV types
@@ -136,14 +137,6 @@ int main(int argc, char *argv[]) {
     });
 
     // main program loop
-    constexpr int POLL_PERIOD_MS = 100;
-    Loop loop(&screen, main_renderer);
-    while (!loop.HasQuitted()) {
-	if (pvgroup.sync()) {
-	    screen.PostEvent(Event::Custom);
-	}
-	loop.RunOnce();
-	std::this_thread::sleep_for(std::chrono::milliseconds(POLL_PERIOD_MS));
-    }
+    app.run(main_renderer);
 
 }
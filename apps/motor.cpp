@@ -23,6 +23,14 @@ Usage:
 Options:
   -h, --help        Show this help message and exit.
   -m, --macro       Macros to pass to the UI (required: P, M, or M1,M2,...)
+  --stats           Show performance statistics (toggle with F12).
+  --trace FILE      Record a Chrome trace to FILE on exit or SIGUSR1.
+  --max-connects N  Channels connecting at once (default 64, 0 for no limit).
+  --decoders N      Threads decoding PV updates (default 0, on the callback thread).
+  --headless        Record PV updates instead of showing the UI.
+  --format FMT      Headless output format, csv (default) or jsonl.
+  --output FILE     Headless output file (default stdout).
+  --max-rate HZ     Headless maximum updates per second for each PV.
 
 Examples:
     # start screen for xxx:m1
@@ -43,8 +51,9 @@ enum class MotorDisplayType {
 
 int main(int argc, char *argv[]) {
 
-    // Parse command line arguments and macros
-    pvtui::ArgParser args(argc, argv);
+    // Instantiate an App to manage the arguments, PVs, and screen
+    App app(argc, argv);
+    ArgParser &args = app.args;
 
     if (args.help(CLI_HELP_MSG)) return EXIT_SUCCESS;
 
@@ -65,18 +74,11 @@ int main(int argc, char *argv[]) {
         return EXIT_FAILURE;
     }
 
-    // Create the FTXUI screen. Interactive and uses the full terminal screen
-    auto screen = ScreenInteractive::Fullscreen();
-
-    // Instantiate EPICS PVA client and CAClientFactory to see CA only PVs
-    epics::pvAccess::ca::CAClientFactory::start();
-    pvac::ClientProvider provider(args.provider);
-
     // unique_ptr's to DisplayBase for each screen
     std::vector<std::unique_ptr<DisplayBase>> displays;
 
     // PVGroup to manage all PVs for displays
-    PVGroup pvgroup(provider);
+    PVGroup &pvgroup = app.pvgroup;
 
     // multi display creates a SmallMotorDisplay for each Mn macro where n is an integer.
     // The resulting screen is similar to motorNx.adl
@@ -138,12 +140,26 @@ int main(int argc, char *argv[]) {
         main_renderer = ftxui::Renderer(main_container, [&] {
             Elements elements;
             for (auto &display : displays) {
-                elements.push_back(display->get_renderer());
+                elements.push_back(display->render());
             }
             return hbox({elements}) | center | EPICSColor::background();
         });
 
     } else {
+        // Only the selected tab's PVs receive updates. Switched when the selection changes
+        // rather than while rendering, since pausing cancels the monitors.
+        int shown = selected;
+        for (size_t i = 0; i < displays.size(); i++) {
+            displays[i]->set_visible(static_cast<int>(i) == shown);
+        }
+        dropdown_op.radiobox.on_change = [&, shown]() mutable {
+            if (selected != shown) {
+                displays.at(selected)->set_visible(true);
+                displays.at(shown)->set_visible(false);
+                shown = selected;
+            }
+        };
+
         auto view_select = ftxui::Dropdown(dropdown_op);
         ftxui::Components tabs;
         for (auto &display : displays) {
@@ -158,7 +174,7 @@ int main(int argc, char *argv[]) {
 
         main_renderer = ftxui::Renderer(main_container, [&] {
             Elements elements;
-            elements.push_back(displays.at(selected)->get_renderer());
+            elements.push_back(displays.at(selected)->render());
             elements.push_back(
                 view_select->Render()
                     | color(Color::White)
@@ -171,14 +187,5 @@ int main(int argc, char *argv[]) {
         });
     }
 
-
-    constexpr int POLL_PERIOD_MS = 100;
-    Loop loop(&screen, main_renderer);
-    while (!loop.HasQuitted()) {
-	if (pvgroup.sync()) {
-	    screen.PostEvent(Event::Custom);
-	}
-        loop.RunOnce();
-        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_PERIOD_MS));
-    }
+    app.run(main_renderer);
 }
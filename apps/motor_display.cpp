@@ -20,7 +20,9 @@ SmallMotorDisplay::SmallMotorDisplay(pvtui::PVGroup &pvgroup, const pvtui::ArgPa
     able(pvgroup, args, "$(P)$(M)_able", pvtui::ChoiceStyle::Horizontal),
     use_set(pvgroup, args, "$(P)$(M).SET", pvtui::ChoiceStyle::Horizontal),
     stop(pvgroup, args, "$(P)$(M).STOP", " STOP ")
-{}
+{
+    track(desc, val, twr, twv, twf, rbv, dmov, lls, hls, lvio, egu, able, use_set, stop);
+}
 
 ftxui::Component SmallMotorDisplay::get_container() {
     using namespace ftxui;
@@ -117,7 +119,10 @@ MediumMotorDisplay::MediumMotorDisplay(pvtui::PVGroup &pvgroup, const pvtui::Arg
     dllm(pvgroup, args, "$(P)$(M).DLLM", pvtui::PVPutType::Double),
     spmg(pvgroup, args, "$(P)$(M).SPMG", pvtui::ChoiceStyle::Vertical),
     able(pvgroup, args, "$(P)$(M)_able", pvtui::ChoiceStyle::Horizontal)
-{}
+{
+    track(desc, val, twr, twv, twf, rbv, dmov, lls, hls, lvio, egu, use_set, drbv, dval, hlm, dhlm,
+          llm, dllm, spmg, able);
+}
 
 ftxui::Component MediumMotorDisplay::get_container() {
     using namespace ftxui;
@@ -257,7 +262,11 @@ AllMotorDisplay::AllMotorDisplay(pvtui::PVGroup &pvgroup, const pvtui::ArgParser
     cnen(pvgroup, args, "$(P)$(M).CNEN", pvtui::ChoiceStyle::Horizontal),
     foff(pvgroup, args, "$(P)$(M).FOFF", pvtui::ChoiceStyle::Dropdown),
     rrbv(pvgroup, args, "$(P)$(M).RRBV")
-{}
+{
+    track(desc, val, twr, twv, twf, rbv, dmov, lls, hls, lvio, egu, use_set, drbv, dval, hlm, dhlm,
+          llm, dllm, spmg, able, vmax, velo, vbas, accl, mres, eres, rres, rtry, off, prec, rlv,
+          rval, ueip, urip, dir, cnen, foff, rrbv);
+}
 
 ftxui::Component AllMotorDisplay::get_container() {
     using namespace ftxui;
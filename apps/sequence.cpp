@@ -24,6 +24,14 @@ Usage:
 Options:
   -h, --help        Show this help message and exit.
   -m, --macro       Macros to pass to the UI (required: P, S)
+  --stats           Show performance statistics (toggle with F12).
+  --trace FILE      Record a Chrome trace to FILE on exit or SIGUSR1.
+  --max-connects N  Channels connecting at once (default 64, 0 for no limit).
+  --decoders N      Threads decoding PV updates (default 0, on the callback thread).
+  --headless        Record PV updates instead of showing the UI.
+  --format FMT      Headless output format, csv (default) or jsonl.
+  --output FILE     Headless output file (default stdout).
+  --max-rate HZ     Headless maximum updates per second for each PV.
 
 Examples:
     pvtui_seq --macro "P=xxx:,C=userSeq1"
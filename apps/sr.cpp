@@ -1,5 +1,3 @@
-#include <numeric>
-
 #include <pv/caProvider.h>
 #include <pva/client.h>
 
@@ -25,31 +23,18 @@ Usage:
 
 Options:
   -h, --help        Show this help message and exit.
+  --stats           Show performance statistics (toggle with F12).
+  --trace FILE      Record a Chrome trace to FILE on exit or SIGUSR1.
+  --max-connects N  Channels connecting at once (default 64, 0 for no limit).
+  --decoders N      Threads decoding PV updates (default 0, on the callback thread).
+  --headless        Record PV updates instead of showing the UI.
+  --format FMT      Headless output format, csv (default) or jsonl.
+  --output FILE     Headless output file (default stdout).
+  --max-rate HZ     Headless maximum updates per second for each PV.
 
 For more details, visit: https://github.com/nmarks99/pvtui
 )";
 
-std::vector<double> downsample_and_clip(const std::vector<double>& input, int target_size, double curr_min, double curr_max, double height) {
-    std::vector<double> result;
-    double chunk_size = static_cast<double>(input.size()) / target_size;
-
-    for (int i = 0; i < target_size; ++i) {
-        int start = static_cast<int>(i * chunk_size);
-        int end = static_cast<int>((i + 1) * chunk_size);
-        end = std::min(end, static_cast<int>(input.size()));
-        if (start >= end) break;
-
-        double sum = std::accumulate(input.begin() + start, input.begin() + end, 0.0);
-        double avg = sum / (end - start);
-
-        double scaled = ((avg - curr_min) / (curr_max - curr_min)) * height;
-        scaled = std::clamp(scaled, 0.0, height);
-        result.push_back(scaled);
-    }
-
-    return result;
-}
-
 std::string debug_string = "";
 
 static const std::unordered_map<int, Element> inj_status_text = {
@@ -94,44 +79,11 @@ int main(int argc, char *argv[]) {
     VarWidget<std::string> next_fill_cont(app, "OPS:message17");
     VarWidget<std::string> next_update(app, "OPS:message18");
 
-    // VarWidget does not work right here since there isn't a way to preallocate 1440
-    std::vector<double> user_ops_current(1440, 0.0);
-    app.pvgroup.add("S:UserOpsCurrent");
-    app.pvgroup.set_monitor("S:UserOpsCurrent", user_ops_current);
-
-    std::vector<double> other_current(1440, 0.0);
-    app.pvgroup.add("S:OtherCurrent");
-    app.pvgroup.set_monitor("S:OtherCurrent", other_current);
-
-    auto plot1_renderer = Renderer([&] {
-        const double CURR_MAX = 200;
-        const double CURR_MIN = 0;
-        const double TARGET_HEIGHT = 50;
-        const int TARGET_WIDTH = 100;
-        auto c = Canvas(TARGET_WIDTH, TARGET_HEIGHT);
-        std::vector<double> comp_user = downsample_and_clip(user_ops_current, TARGET_WIDTH, CURR_MIN, CURR_MAX, TARGET_HEIGHT);
-        std::vector<double> comp_other = downsample_and_clip(other_current, TARGET_WIDTH, CURR_MIN, CURR_MAX, TARGET_HEIGHT);
-
-        // "user" current
-        std::vector<int> y1(comp_user.size());
-        for (size_t x = 0; x < comp_user.size(); x++) {
-            y1[x] = static_cast<int>(TARGET_HEIGHT-(comp_user.at(x)));
-        }
-        for (size_t x = 1; x < comp_user.size()-1; x++) {
-            c.DrawPointLine(x, y1[x], x + 1, y1[x + 1], Color::Blue);
-        }
-
-        // "other" current
-        std::vector<int> y2(comp_other.size());
-        for (size_t x = 0; x < comp_other.size(); x++) {
-            y2[x] = static_cast<int>(TARGET_HEIGHT-(comp_other.at(x)));
-        }
-        for (size_t x = 1; x < comp_other.size()-1; x++) {
-            c.DrawPointLine(x, y2[x], x + 1, y2[x + 1], Color::Red);
-        }
-
-        return canvas(std::move(c));
-    });
+    // 1440 point history waveforms, shared with the monitor rather than copied
+    WaveformWidget user_ops_current(app, "S:UserOpsCurrent", Color::Blue);
+    WaveformWidget other_current(app, "S:OtherCurrent", Color::Red);
+    user_ops_current.add_trace(other_current);
+    user_ops_current.set_range(0.0, 200.0);
 
     // Container for "q" to quit
     auto main_container = Container::Vertical({});
@@ -188,7 +140,7 @@ int main(int argc, char *argv[]) {
                     }),
                     separator(),
                     separatorEmpty(),
-                    plot1_renderer->Render(),
+                    user_ops_current.render(100, 50),
                     separatorEmpty(),
                 }),
                 separator(),
@@ -0,0 +1,94 @@
+#include <pvtui/decimate.hpp>
+
+#include <algorithm>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace pvtui {
+
+namespace {
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+// Minimum and maximum of [begin, end), skipping NaN. Both stay infinite if nothing is finite.
+void chunk_minmax(const double* begin, const double* end, double& lo, double& hi) {
+    double mn = INF;
+    double mx = -INF;
+    const double* p = begin;
+
+#if defined(__SSE2__)
+    if (end - p >= 4) {
+        // Two accumulators per bound hide the latency of minpd/maxpd. The sample is the
+        // first operand, so a NaN sample returns the accumulator and is skipped.
+        __m128d mn0 = _mm_set1_pd(INF);
+        __m128d mn1 = mn0;
+        __m128d mx0 = _mm_set1_pd(-INF);
+        __m128d mx1 = mx0;
+        for (; end - p >= 4; p += 4) {
+            const __m128d a = _mm_loadu_pd(p);
+            const __m128d b = _mm_loadu_pd(p + 2);
+            mn0 = _mm_min_pd(a, mn0);
+            mn1 = _mm_min_pd(b, mn1);
+            mx0 = _mm_max_pd(a, mx0);
+            mx1 = _mm_max_pd(b, mx1);
+        }
+        double lanes[2];
+        _mm_storeu_pd(lanes, _mm_min_pd(mn0, mn1));
+        mn = std::min(lanes[0], lanes[1]);
+        _mm_storeu_pd(lanes, _mm_max_pd(mx0, mx1));
+        mx = std::max(lanes[0], lanes[1]);
+    }
+#elif defined(__aarch64__)
+    if (end - p >= 4) {
+        // fminnm/fmaxnm return the number when one operand is NaN
+        float64x2_t mn0 = vdupq_n_f64(INF);
+        float64x2_t mn1 = mn0;
+        float64x2_t mx0 = vdupq_n_f64(-INF);
+        float64x2_t mx1 = mx0;
+        for (; end - p >= 4; p += 4) {
+            const float64x2_t a = vld1q_f64(p);
+            const float64x2_t b = vld1q_f64(p + 2);
+            mn0 = vminnmq_f64(a, mn0);
+            mn1 = vminnmq_f64(b, mn1);
+            mx0 = vmaxnmq_f64(a, mx0);
+            mx1 = vmaxnmq_f64(b, mx1);
+        }
+        mn = vminnmvq_f64(vminnmq_f64(mn0, mn1));
+        mx = vmaxnmvq_f64(vmaxnmq_f64(mx0, mx1));
+    }
+#endif
+
+    for (; p < end; ++p) {
+        const double v = *p;
+        mn = v < mn ? v : mn;
+        mx = v > mx ? v : mx;
+    }
+    lo = mn;
+    hi = mx;
+}
+} // namespace
+
+void minmax_decimate(const double* data, size_t size, size_t columns, double* min_out, double* max_out) {
+    for (size_t i = 0; i < columns; i++) {
+        if (size == 0) {
+            min_out[i] = INF;
+            max_out[i] = -INF;
+            continue;
+        }
+        const size_t start = std::min(i * size / columns, size - 1);
+        const size_t end = std::max((i + 1) * size / columns, start + 1);
+        chunk_minmax(data + start, data + end, min_out[i], max_out[i]);
+    }
+}
+
+void minmax_decimate(const double* data, size_t size, size_t columns, WaveformEnvelope& envelope) {
+    envelope.min.resize(columns);
+    envelope.max.resize(columns);
+    minmax_decimate(data, size, columns, envelope.min.data(), envelope.max.data());
+}
+
+} // namespace pvtui
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace pvtui {
+
+/**
+ * @brief Per-column minimum and maximum of a decimated waveform.
+ *
+ * A column without any finite samples has min greater than max.
+ */
+struct WaveformEnvelope {
+    std::vector<double> min; ///< Smallest sample of each column.
+    std::vector<double> max; ///< Largest sample of each column.
+
+    /**
+     * @brief Gets the number of columns.
+     * @return The size of min and max.
+     */
+    size_t size() const { return min.size(); }
+};
+
+/**
+ * @brief Reduces a waveform to the minimum and maximum of each of a number of columns.
+ *
+ * Column i covers the samples [i * size / columns, (i + 1) * size / columns), or the single
+ * sample at the start of that range if the waveform has fewer samples than columns. Unlike
+ * averaging, a spike of a single sample stays visible after decimation. NaN samples are
+ * skipped. Uses SSE2 or NEON when available.
+ * @param data The samples.
+ * @param size Number of samples.
+ * @param columns Number of columns, e.g. the canvas width.
+ * @param min_out Receives the minimum of each column, must hold columns values.
+ * @param max_out Receives the maximum of each column, must hold columns values.
+ */
+void minmax_decimate(const double* data, size_t size, size_t columns, double* min_out, double* max_out);
+
+/**
+ * @brief Reduces a waveform to the minimum and maximum of each of a number of columns.
+ * @param data The samples.
+ * @param size Number of samples.
+ * @param columns Number of columns, e.g. the canvas width.
+ * @param envelope Receives the result, resized to columns.
+ */
+void minmax_decimate(const double* data, size_t size, size_t columns, WaveformEnvelope& envelope);
+
+} // namespace pvtui
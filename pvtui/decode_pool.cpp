@@ -0,0 +1,117 @@
+#include <pvtui/decode_pool.hpp>
+
+#include <algorithm>
+
+namespace pvtui {
+
+namespace {
+// The pool and worker index of the calling thread, if it is a pool worker
+thread_local const DecodePool* t_pool = nullptr;
+thread_local size_t t_worker = 0;
+} // namespace
+
+DecodePool::DecodePool(size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    // Only start once every queue exists, since workers steal from all of them
+    for (size_t i = 0; i < threads; i++) {
+        workers_[i]->thread = std::thread(&DecodePool::run, this, i);
+    }
+}
+
+DecodePool::~DecodePool() {
+    {
+        const std::lock_guard<std::mutex> lock(wake_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        worker->thread.join();
+    }
+}
+
+void DecodePool::submit(Task task) {
+    const size_t index =
+        t_pool == this ? t_worker : next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+    // Counted before the push, so neither count drops below zero. A worker which sees
+    // queued_ before the push is done just looks again.
+    pending_.fetch_add(1);
+    queued_.fetch_add(1);
+    {
+        Worker& worker = *workers_[index];
+        const std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    // A worker counts itself in sleepers_ before it checks queued_, so one of the two
+    // sees the other. Taking the mutex makes sure it is waiting before it is notified.
+    if (sleepers_.load() > 0) {
+        { const std::lock_guard<std::mutex> lock(wake_mutex_); }
+        wake_.notify_one();
+    }
+}
+
+void DecodePool::wait_idle() {
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    idle_waiters_.fetch_add(1);
+    idle_.wait(lock, [this] { return pending_.load() == 0; });
+    idle_waiters_.fetch_sub(1);
+}
+
+void DecodePool::finish_task() {
+    if (pending_.fetch_sub(1) == 1 && idle_waiters_.load() > 0) {
+        { const std::lock_guard<std::mutex> lock(wake_mutex_); }
+        idle_.notify_all();
+    }
+}
+
+bool DecodePool::take(size_t index, Task& task) {
+    {
+        Worker& own = *workers_[index];
+        const std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    for (size_t i = 1; i < workers_.size(); i++) {
+        Worker& victim = *workers_[(index + i) % workers_.size()];
+        const std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void DecodePool::run(size_t index) {
+    t_pool = this;
+    t_worker = index;
+    Task task;
+    while (true) {
+        if (this->take(index, task)) {
+            task();
+            task = nullptr;
+            this->finish_task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        sleepers_.fetch_add(1);
+        wake_.wait(lock, [this] { return stop_ || queued_.load() > 0; });
+        sleepers_.fetch_sub(1);
+        if (stop_ && queued_.load() == 0) {
+            return;
+        }
+    }
+}
+
+} // namespace pvtui
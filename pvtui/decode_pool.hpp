@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pvtui {
+
+/**
+ * @brief A small work-stealing thread pool which decodes monitor updates off the callback thread.
+ *
+ * PVA delivers the monitor updates of all channels on one callback thread, so with
+ * dozens of large waveforms the type conversion in that thread limits the update rate.
+ * A PVHandler given a pool with PVHandler::set_decode_pool() only keeps a reference to
+ * the newest update in the callback and submits its decode here. Each worker has its own
+ * queue and takes work from the back of it; an idle worker steals from the front of the
+ * others' queues, so a burst on a few PVs is still spread over all workers.
+ */
+class DecodePool {
+  public:
+    using Task = std::function<void()>;
+
+    /**
+     * @brief Starts the worker threads.
+     * @param threads Number of workers, or 0 for one per hardware thread.
+     */
+    explicit DecodePool(size_t threads = 0);
+
+    /**
+     * @brief Runs the tasks still queued, then stops the workers.
+     */
+    ~DecodePool();
+
+    DecodePool(const DecodePool&) = delete;
+    DecodePool& operator=(const DecodePool&) = delete;
+
+    /**
+     * @brief Gets the number of worker threads.
+     * @return At least 1.
+     */
+    size_t size() const { return workers_.size(); }
+
+    /**
+     * @brief Queues a task to run on one of the workers. Safe to call from any thread.
+     *
+     * Called from a worker, the task goes to that worker's own queue.
+     * @param task The function to run. Must not throw.
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Blocks until every submitted task has finished.
+     */
+    void wait_idle();
+
+  private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks; ///< Owner pops from the back, thieves from the front.
+        std::thread thread;
+    };
+
+    /**
+     * @brief Takes a task from a worker's own queue, or steals one from another worker.
+     * @param index The worker taking the task.
+     * @param task Receives the task.
+     * @return True if a task was taken.
+     */
+    bool take(size_t index, Task& task);
+
+    /**
+     * @brief Counts a finished task, waking wait_idle() if it was the last one.
+     */
+    void finish_task();
+
+    /**
+     * @brief Worker thread loop.
+     * @param index The worker's index in workers_.
+     */
+    void run(size_t index);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<size_t> next_worker_{0};  ///< Round robin queue for tasks submitted by other threads.
+    std::atomic<size_t> queued_{0};       ///< Tasks submitted but not yet taken.
+    std::atomic<size_t> pending_{0};      ///< Tasks submitted but not yet finished.
+    std::atomic<size_t> sleepers_{0};     ///< Workers waiting on wake_.
+    std::atomic<size_t> idle_waiters_{0}; ///< Threads waiting on idle_.
+    std::mutex wake_mutex_;               ///< Protects stop_. Only taken to sleep or to wake sleepers.
+    std::condition_variable wake_;        ///< Signaled when a task is queued or the pool stops.
+    std::condition_variable idle_;        ///< Signaled when pending_ drops to zero.
+    bool stop_ = false;                   ///< True once the destructor runs.
+};
+
+} // namespace pvtui
@@ -2,6 +2,7 @@
 #include <ftxui/component/component_base.hpp>
 #include <pvtui/pvgroup.hpp>
 #include <pvtui/pvtui.hpp>
+#include <pvtui/trace.hpp>
 
 namespace pvtui {
 
@@ -48,8 +49,55 @@ class DisplayBase {
      */
     virtual ftxui::Component get_container() = 0;
 
+    /**
+     * @brief Gets the display's element, only calling get_renderer() when it may have changed.
+     *
+     * Displays which register their widgets with track() are rebuilt only when one of
+     * them changed or after terminal input. Other displays are rebuilt on every call.
+     * @return An FTXUI Element representing the display's visual content.
+     */
+    ftxui::Element render() {
+        if (!tracking_) {
+            PVTUI_TRACE("DisplayBase::render");
+            return this->get_renderer();
+        }
+        return cache_.get([this] {
+            PVTUI_TRACE("DisplayBase::render");
+            return this->get_renderer();
+        });
+    }
+
+    /**
+     * @brief Shows or hides the display, e.g. when its tab is selected or deselected.
+     *
+     * Calls WidgetBase::set_visible() on the widgets registered with track(), so PVs only
+     * used by hidden displays stop receiving updates until the display is shown again.
+     * @param visible False to pause the updates of this display's PVs.
+     */
+    void set_visible(bool visible) {
+        for (WidgetBase* widget : widgets_) {
+            widget->set_visible(visible);
+        }
+    }
+
   protected:
+    /**
+     * @brief Registers widgets drawn by get_renderer() so render() can cache its element
+     * and set_visible() can pause them.
+     * @param widgets All widgets used in get_renderer().
+     */
+    template <typename... Widgets> void track(Widgets&... widgets) {
+        cache_.track(widgets...);
+        (widgets_.push_back(&widgets), ...);
+        tracking_ = true;
+    }
+
     pvtui::PVGroup& pvgroup; ///< Reference to the PVGroup instance.
+
+  private:
+    ElementCache cache_;                ///< Cached element returned by render().
+    bool tracking_ = false;             ///< True once track() has been called.
+    std::vector<WidgetBase*> widgets_;  ///< Widgets registered with track().
 };
 
 } // namespace pvtui
@@ -0,0 +1,118 @@
+#include <pvtui/history.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace pvtui {
+
+SampleHistory::SampleHistory(size_t capacity)
+    : capacity_(std::max<size_t>(capacity, 1)), samples_(capacity_) {}
+
+void SampleHistory::push(double time, double value) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const HistorySample sample{time, value};
+    samples_[next_] = sample;
+    next_ = (next_ + 1) % capacity_;
+    size_ = std::min(size_ + 1, capacity_);
+    if (column_seconds_ > 0.0) {
+        this->add_to_columns(sample);
+    }
+}
+
+size_t SampleHistory::size() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return size_;
+}
+
+std::optional<HistorySample> SampleHistory::newest() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (size_ == 0) {
+        return std::nullopt;
+    }
+    return samples_[(next_ + capacity_ - 1) % capacity_];
+}
+
+std::vector<HistorySample> SampleHistory::samples() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<HistorySample> out;
+    out.reserve(size_);
+    const size_t oldest = (next_ + capacity_ - size_) % capacity_;
+    for (size_t i = 0; i < size_; i++) {
+        out.push_back(samples_[(oldest + i) % capacity_]);
+    }
+    return out;
+}
+
+void SampleHistory::add_to_columns(const HistorySample& sample) {
+    if (std::isnan(sample.value)) {
+        return;
+    }
+    const int64_t index = static_cast<int64_t>(std::floor(sample.time / column_seconds_));
+    if (column_count_ > 0) {
+        Column& newest = columns_[(next_column_ + columns_.size() - 1) % columns_.size()];
+        if (index <= newest.index) {
+            newest.min = std::min(newest.min, sample.value);
+            newest.max = std::max(newest.max, sample.value);
+            newest.last = sample.value;
+            return;
+        }
+    }
+    columns_[next_column_] = Column{index, sample.value, sample.value, sample.value};
+    next_column_ = (next_column_ + 1) % columns_.size();
+    column_count_ = std::min(column_count_ + 1, columns_.size());
+}
+
+void SampleHistory::envelope(double end, size_t columns, double column_seconds, WaveformEnvelope& envelope) {
+    envelope.min.resize(columns);
+    envelope.max.resize(columns);
+    if (columns == 0 || !(column_seconds > 0.0)) {
+        return;
+    }
+
+    const std::lock_guard<std::mutex> lock(mutex_);
+    // One extra column keeps the value held at the left edge of the window
+    if (columns_.size() != columns + 1 || column_seconds_ != column_seconds) {
+        columns_.assign(columns + 1, Column{});
+        next_column_ = 0;
+        column_count_ = 0;
+        column_seconds_ = column_seconds;
+        const size_t oldest = (next_ + capacity_ - size_) % capacity_;
+        for (size_t i = 0; i < size_; i++) {
+            this->add_to_columns(samples_[(oldest + i) % capacity_]);
+        }
+    }
+
+    const size_t kept = columns_.size();
+    const size_t oldest = (next_column_ + kept - column_count_) % kept;
+    auto column = [&](size_t i) -> const Column& { return columns_[(oldest + i) % kept]; };
+
+    const int64_t first = static_cast<int64_t>(std::floor(end / column_seconds)) - static_cast<int64_t>(columns) + 1;
+    size_t next = 0;
+    bool held = false;
+    double hold = 0.0;
+    for (size_t x = 0; x < columns; x++) {
+        const int64_t index = first + static_cast<int64_t>(x);
+        // Columns left of the window only set the held value
+        while (next < column_count_ && column(next).index < index) {
+            hold = column(next).last;
+            held = true;
+            next++;
+        }
+        if (next < column_count_ && column(next).index == index) {
+            envelope.min[x] = column(next).min;
+            envelope.max[x] = column(next).max;
+            hold = column(next).last;
+            held = true;
+            next++;
+        } else if (held) {
+            envelope.min[x] = hold;
+            envelope.max[x] = hold;
+        } else {
+            envelope.min[x] = std::numeric_limits<double>::infinity();
+            envelope.max[x] = -std::numeric_limits<double>::infinity();
+        }
+    }
+}
+
+} // namespace pvtui
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include <pvtui/decimate.hpp>
+
+namespace pvtui {
+
+/**
+ * @brief A sample of a scalar PV.
+ */
+struct HistorySample {
+    double time = 0.0;  ///< Server timestamp in seconds since the POSIX epoch.
+    double value = 0.0; ///< The value.
+};
+
+/**
+ * @brief A fixed capacity history of a scalar PV, decimated into time columns as it grows.
+ *
+ * Samples are kept in a ring buffer allocated up front, so the oldest are overwritten once
+ * it is full. Each sample is also folded into the min/max of the time column it falls in,
+ * so drawing costs O(columns) no matter how long the history is. The columns are only
+ * rebuilt from the samples when their number or duration changes. Safe to push from one
+ * thread while another reads.
+ */
+class SampleHistory {
+  public:
+    /**
+     * @brief Constructs an empty history.
+     * @param capacity Maximum number of samples kept.
+     */
+    explicit SampleHistory(size_t capacity);
+
+    /**
+     * @brief Appends a sample, overwriting the oldest if the history is full.
+     *
+     * A sample older than the newest one is counted in the newest column.
+     * @param time Timestamp in seconds.
+     * @param value The value.
+     */
+    void push(double time, double value);
+
+    /**
+     * @brief Gets the number of samples kept.
+     * @return At most capacity().
+     */
+    size_t size() const;
+
+    /**
+     * @brief Gets the maximum number of samples kept.
+     * @return The capacity given to the constructor.
+     */
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * @brief Gets the newest sample.
+     * @return The sample pushed last, or std::nullopt if the history is empty.
+     */
+    std::optional<HistorySample> newest() const;
+
+    /**
+     * @brief Copies the samples kept.
+     * @return The samples, oldest first.
+     */
+    std::vector<HistorySample> samples() const;
+
+    /**
+     * @brief Reduces the history in a time window to the min/max of each column.
+     *
+     * Column i covers [end - (columns - i) * column_seconds, end - (columns - i - 1) *
+     * column_seconds), aligned to multiples of column_seconds. A column without samples
+     * holds the last value before it, or is empty (min > max) if there is none.
+     * @param end Time at the right edge of the window, e.g. now.
+     * @param columns Number of columns, e.g. the canvas width.
+     * @param column_seconds Duration of each column.
+     * @param envelope Receives the result, resized to columns.
+     */
+    void envelope(double end, size_t columns, double column_seconds, WaveformEnvelope& envelope);
+
+  private:
+    struct Column {
+        int64_t index = 0; ///< Start time divided by column_seconds_.
+        double min = 0.0;
+        double max = 0.0;
+        double last = 0.0; ///< Newest value, held until the next column with samples.
+    };
+
+    /**
+     * @brief Folds a sample into the newest column or starts a new one. Requires mutex_.
+     * @param sample The sample.
+     */
+    void add_to_columns(const HistorySample& sample);
+
+    mutable std::mutex mutex_;
+    const size_t capacity_;
+    std::vector<HistorySample> samples_; ///< Ring buffer of samples.
+    size_t next_ = 0;                    ///< Where the next sample is written.
+    size_t size_ = 0;                    ///< Number of samples kept.
+    std::vector<Column> columns_;        ///< Ring buffer of decimated columns.
+    size_t next_column_ = 0;             ///< Where the next column is written.
+    size_t column_count_ = 0;            ///< Number of columns kept.
+    double column_seconds_ = 0.0;        ///< Column duration columns_ was built for, 0 if not built.
+};
+
+} // namespace pvtui
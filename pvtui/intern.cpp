@@ -0,0 +1,108 @@
+#include <pvtui/intern.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+namespace pvtui {
+
+namespace {
+
+// Weak references to shared values, bucketed by a hash of their contents
+template <typename T> class InternPool {
+  public:
+    // Returns the live value with this hash for which equal() holds, or a new one from make()
+    template <typename Equal, typename Make>
+    std::shared_ptr<const T> get(size_t hash, Equal&& equal, Make&& make) {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        auto range = entries_.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (auto existing = it->second.lock()) {
+                if (equal(*existing)) {
+                    return existing;
+                }
+            }
+        }
+
+        // Bounds the pool to about twice the number of live values
+        if (entries_.size() >= purge_at_) {
+            for (auto it = entries_.begin(); it != entries_.end();) {
+                it = it->second.expired() ? entries_.erase(it) : std::next(it);
+            }
+            purge_at_ = std::max(MIN_PURGE, 2 * entries_.size());
+        }
+
+        // Not make_shared, which would keep the memory until the weak_ptr is gone
+        std::shared_ptr<const T> value(new T(make()));
+        entries_.emplace(hash, value);
+        return value;
+    }
+
+    size_t count() {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        return std::count_if(entries_.begin(), entries_.end(),
+                             [](const auto& entry) { return !entry.second.expired(); });
+    }
+
+  private:
+    static constexpr size_t MIN_PURGE = 64;
+
+    std::mutex mutex_;
+    std::unordered_multimap<size_t, std::weak_ptr<const T>> entries_;
+    size_t purge_at_ = MIN_PURGE;
+};
+
+// Leaked so values can be released during static destruction
+InternPool<std::vector<std::string>>& choice_pool() {
+    static auto* pool = new InternPool<std::vector<std::string>>();
+    return *pool;
+}
+
+InternPool<std::string>& string_pool() {
+    static auto* pool = new InternPool<std::string>();
+    return *pool;
+}
+} // namespace
+
+ChoiceList intern_choices(const std::string* choices, size_t count) {
+    if (count == 0) {
+        return empty_choices();
+    }
+    size_t hash = count;
+    for (size_t i = 0; i < count; i++) {
+        hash = hash * 31 + std::hash<std::string>()(choices[i]);
+    }
+    return choice_pool().get(
+        hash,
+        [&](const std::vector<std::string>& list) {
+            return list.size() == count && std::equal(list.begin(), list.end(), choices);
+        },
+        [&]() { return std::vector<std::string>(choices, choices + count); });
+}
+
+const ChoiceList& empty_choices() {
+    static const ChoiceList empty = std::make_shared<const std::vector<std::string>>();
+    return empty;
+}
+
+size_t interned_choices_count() { return choice_pool().count(); }
+
+InternedString::InternedString() {
+    static const std::shared_ptr<const std::string> empty = std::make_shared<const std::string>();
+    str_ = empty;
+}
+
+InternedString::InternedString(std::string_view str) {
+    if (str.empty()) {
+        *this = InternedString();
+        return;
+    }
+    str_ = string_pool().get(
+        std::hash<std::string_view>()(str), [&](const std::string& existing) { return existing == str; },
+        [&]() { return std::string(str); });
+}
+
+size_t InternedString::count() { return string_pool().count(); }
+
+} // namespace pvtui
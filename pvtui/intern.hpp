@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pvtui {
+
+/**
+ * @brief An immutable list of enum choices, shared by every PVEnum with the same choices.
+ */
+using ChoiceList = std::shared_ptr<const std::vector<std::string>>;
+
+/**
+ * @brief Gets the shared list with the given choices, creating it if no live list has them.
+ *
+ * The pool only holds weak references, so a list is freed once the last PVEnum using it
+ * is gone, and expired entries are dropped as the pool grows.
+ * @param choices Pointer to the first choice.
+ * @param count Number of choices.
+ * @return A list equal to the given choices. Never null.
+ */
+ChoiceList intern_choices(const std::string* choices, size_t count);
+
+/**
+ * @brief Gets the shared list with the given choices.
+ * @param choices The choices.
+ * @return A list equal to choices. Never null.
+ */
+inline ChoiceList intern_choices(const std::vector<std::string>& choices) {
+    return intern_choices(choices.data(), choices.size());
+}
+
+/**
+ * @brief Gets the shared empty choice list, used before a PVEnum receives its first value.
+ * @return The empty list.
+ */
+const ChoiceList& empty_choices();
+
+/**
+ * @brief Gets the number of live choice lists in the pool.
+ * @return The number of distinct choice lists in use.
+ */
+size_t interned_choices_count();
+
+/**
+ * @brief A string shared by every InternedString with the same contents.
+ *
+ * Used for PV names, which are otherwise copied into each PVGroup, widget, handler, and
+ * shared channel. Copying is a reference count increment and equality compares pointers.
+ * Like choice lists, strings are freed when the last reference is gone.
+ */
+class InternedString {
+  public:
+    /**
+     * @brief Constructs an empty string.
+     */
+    InternedString();
+
+    /**
+     * @brief Constructs the shared string equal to str.
+     * @param str The contents.
+     */
+    explicit InternedString(std::string_view str);
+
+    /**
+     * @brief Gets the string.
+     * @return A reference valid as long as this object.
+     */
+    const std::string& str() const { return *str_; }
+
+    /**
+     * @brief Gets the string as a C string.
+     * @return A pointer valid as long as this object.
+     */
+    const char* c_str() const { return str_->c_str(); }
+
+    /**
+     * @brief Gets the string as a view.
+     * @return A view valid as long as this object.
+     */
+    std::string_view view() const { return *str_; }
+
+    bool empty() const { return str_->empty(); } ///< True for the empty string.
+    size_t size() const { return str_->size(); } ///< Length in bytes.
+
+    /// @brief Allows passing an InternedString wherever a const std::string& is expected.
+    operator const std::string&() const { return *str_; }
+
+    friend bool operator==(const InternedString& a, const InternedString& b) { return a.str_ == b.str_; }
+    friend bool operator!=(const InternedString& a, const InternedString& b) { return a.str_ != b.str_; }
+    friend bool operator==(const InternedString& a, std::string_view b) { return a.view() == b; }
+    friend bool operator!=(const InternedString& a, std::string_view b) { return a.view() != b; }
+    friend bool operator<(const InternedString& a, const InternedString& b) { return *a.str_ < *b.str_; }
+
+    /**
+     * @brief Gets the number of live strings in the pool.
+     * @return The number of distinct strings in use.
+     */
+    static size_t count();
+
+  private:
+    std::shared_ptr<const std::string> str_; ///< Never null.
+};
+
+} // namespace pvtui
@@ -1,196 +1,1471 @@
 #include <pvtui/pvgroup.hpp>
-#include <regex>
+#include <pvtui/decode_pool.hpp>
+#include <pvtui/trace.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
 
 namespace pvtui {
 
+UpdateNotifier::UpdateNotifier() {
+#ifdef __linux__
+    read_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    write_fd_ = read_fd_;
+    if (read_fd_ < 0) {
+        throw std::runtime_error(std::string("Failed to create eventfd: ") + std::strerror(errno));
+    }
+#else
+    int fds[2];
+    if (pipe(fds) != 0) {
+        throw std::runtime_error(std::string("Failed to create pipe: ") + std::strerror(errno));
+    }
+    for (int fd : fds) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    read_fd_ = fds[0];
+    write_fd_ = fds[1];
+#endif
+}
+
+UpdateNotifier::~UpdateNotifier() {
+    close(read_fd_);
+    if (write_fd_ != read_fd_) {
+        close(write_fd_);
+    }
+}
+
+void UpdateNotifier::notify() {
+    // Only the first notification after clear() needs to touch the file descriptor
+    if (pending_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    const uint64_t one = 1;
+    ssize_t ret;
+    do {
+        ret = write(write_fd_, &one, sizeof(one));
+    } while (ret < 0 && errno == EINTR);
+}
+
+void UpdateNotifier::clear() {
+    uint64_t buf;
+    while (read(read_fd_, &buf, sizeof(buf)) > 0) {
+    }
+    pending_.store(false, std::memory_order_release);
+}
+
+void UpdateQueue::push(PVHandler* pv) {
+    if (pv->queued_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    PVHandler* head = head_.load(std::memory_order_relaxed);
+    do {
+        pv->next_queued_ = head;
+    } while (!head_.compare_exchange_weak(head, pv, std::memory_order_release, std::memory_order_relaxed));
+}
+
 void ConnectionMonitor::connectEvent(const pvac::ConnectEvent& event) {
     connected_.store(event.connected, std::memory_order_relaxed);
+    if (notifier_) {
+        notifier_->notify();
+    }
 }
 
 bool ConnectionMonitor::connected() const { return connected_.load(std::memory_order_relaxed); }
 
-PVHandler::PVHandler(pvac::ClientProvider& provider, const std::string& pv_name)
-    : channel(provider.connect(pv_name)), name(pv_name), monitor_(channel.monitor(this)),
-      connection_monitor_(std::make_shared<ConnectionMonitor>()) {
-    channel.addConnectListener(connection_monitor_.get());
+namespace {
+// Process-wide registry of shared channels
+std::mutex g_channels_mutex;
+std::map<std::pair<const pvac::ClientProvider*, InternedString>, std::weak_ptr<SharedChannel>> g_channels;
+
+// State of the ConnectScheduler. Channels are opened on the timer queue's thread.
+struct Scheduler : public epicsTimerNotify {
+    using clock = std::chrono::steady_clock;
+
+    std::mutex mutex;
+    size_t limit = 0;
+    std::deque<std::weak_ptr<SharedChannel>> queue;    // in request order
+    std::deque<std::weak_ptr<SharedChannel>> urgent;   // prioritized, opened first
+    std::vector<std::pair<std::weak_ptr<SharedChannel>, clock::time_point>> connecting;
+    std::vector<std::weak_ptr<SharedChannel>> timed_out; // pruned by ConnectScheduler::stats()
+    size_t peak_connecting = 0;
+    size_t channels = 0;
+    size_t connected = 0;
+    clock::time_point started;
+    double all_connected_ms = -1.0;
+    std::function<void(const std::string&)> open_hook;
+    epicsTimerQueueActive* timer_queue = nullptr;
+    epicsTimer* timer = nullptr;
+
+    // Starts the timer after delay seconds. Requires mutex.
+    void wake(double delay) {
+        if (!timer) {
+            timer_queue = &epicsTimerQueueActive::allocate(true);
+            timer = &timer_queue->createTimer();
+        }
+        timer->start(*this, delay);
+    }
+
+    // Takes the channels to open next. Requires mutex. Channels locked here go into keep,
+    // so the last reference is never dropped while holding mutex.
+    std::vector<std::shared_ptr<SharedChannel>> take_next(std::vector<std::shared_ptr<SharedChannel>>& keep) {
+        const auto now = clock::now();
+        const auto timeout = std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<double>(ConnectScheduler::CONNECT_TIMEOUT));
+        connecting.erase(std::remove_if(connecting.begin(), connecting.end(),
+                                        [&](const auto& entry) {
+                                            auto channel = entry.first.lock();
+                                            if (!channel || channel->connected_once()) {
+                                                keep.push_back(std::move(channel));
+                                                return true;
+                                            }
+                                            if (now - entry.second >= timeout) {
+                                                timed_out.push_back(entry.first);
+                                                keep.push_back(std::move(channel));
+                                                return true;
+                                            }
+                                            keep.push_back(std::move(channel));
+                                            return false;
+                                        }),
+                         connecting.end());
+
+        std::vector<std::shared_ptr<SharedChannel>> next;
+        while (connecting.size() < limit && (!urgent.empty() || !queue.empty())) {
+            auto& from = urgent.empty() ? queue : urgent;
+            auto channel = from.front().lock();
+            from.pop_front();
+            if (channel && !channel->opened()) {
+                connecting.emplace_back(channel, now);
+                next.push_back(std::move(channel));
+            } else {
+                keep.push_back(std::move(channel));
+            }
+        }
+        peak_connecting = std::max(peak_connecting, connecting.size());
+        return next;
+    }
+
+    expireStatus expire(const epicsTime&) override {
+        std::vector<std::shared_ptr<SharedChannel>> keep;
+        std::vector<std::shared_ptr<SharedChannel>> next;
+        std::function<void(const std::string&)> hook;
+        bool waiting;
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            next = take_next(keep);
+            waiting = !urgent.empty() || !queue.empty() || !connecting.empty();
+            hook = open_hook;
+        }
+        // Outside the lock, connect callbacks may run before open() returns
+        for (auto& channel : next) {
+            channel->open();
+            if (hook) {
+                hook(channel->name());
+            }
+        }
+
+        // Check again later for channels which stopped counting against the limit
+        return waiting ? expireStatus(restart, 0.1) : expireStatus(noRestart);
+    }
+};
+
+Scheduler& scheduler() {
+    static Scheduler* instance = new Scheduler; // never destroyed, the timer may outlive main()
+    return *instance;
+}
+} // namespace
+
+void ConnectScheduler::set_limit(size_t max_connecting) {
+    Scheduler& sched = scheduler();
+    const std::lock_guard<std::mutex> lock(sched.mutex);
+    sched.limit = max_connecting;
 }
 
-void PVHandler::monitorEvent(const pvac::MonitorEvent& evt) {
-    switch (evt.event) {
-    case pvac::MonitorEvent::Data:
-        while (monitor_.poll()) {
-            this->get_monitored_variable(monitor_.root.get());
+size_t ConnectScheduler::limit() {
+    Scheduler& sched = scheduler();
+    const std::lock_guard<std::mutex> lock(sched.mutex);
+    return sched.limit;
+}
+
+ConnectStats ConnectScheduler::stats() {
+    Scheduler& sched = scheduler();
+    // Released after the lock, since dropping the last reference calls released()
+    std::vector<std::shared_ptr<SharedChannel>> keep;
+    const std::lock_guard<std::mutex> lock(sched.mutex);
+    ConnectStats out;
+    out.channels = sched.channels;
+    out.queued = sched.queue.size() + sched.urgent.size();
+    for (const auto& entry : sched.connecting) {
+        auto channel = entry.first.lock();
+        if (channel && !channel->connected_once()) {
+            out.connecting++;
         }
-        break;
-    case pvac::MonitorEvent::Disconnect:
-        break;
-    case pvac::MonitorEvent::Fail:
-        break;
-    case pvac::MonitorEvent::Cancel:
-        break;
+        keep.push_back(std::move(channel));
     }
+    out.peak_connecting = sched.peak_connecting;
+    // Channels which connect late or go away no longer count as timed out
+    sched.timed_out.erase(std::remove_if(sched.timed_out.begin(), sched.timed_out.end(),
+                                         [&keep](const auto& weak) {
+                                             auto channel = weak.lock();
+                                             const bool done = !channel || channel->connected_once();
+                                             keep.push_back(std::move(channel));
+                                             return done;
+                                         }),
+                          sched.timed_out.end());
+    out.timed_out = sched.timed_out.size();
+    out.connected = sched.connected;
+    out.all_connected_ms = sched.all_connected_ms;
+    return out;
 }
 
-bool PVHandler::connected() const { return connection_monitor_->connected(); }
+void ConnectScheduler::set_open_hook(std::function<void(const std::string&)> hook) {
+    Scheduler& sched = scheduler();
+    const std::lock_guard<std::mutex> lock(sched.mutex);
+    sched.open_hook = std::move(hook);
+}
 
-void PVHandler::get_monitored_variable(const epics::pvData::PVStructure* pfield) {
-    namespace pvd = epics::pvData;
+void ConnectScheduler::request(const std::shared_ptr<SharedChannel>& channel) {
+    Scheduler& sched = scheduler();
+    {
+        const std::lock_guard<std::mutex> lock(sched.mutex);
+        if (sched.channels == sched.connected) {
+            // Everything was connected, start timing the new batch
+            sched.started = Scheduler::clock::now();
+            sched.all_connected_ms = -1.0;
+        }
+        sched.channels++;
+        if (sched.limit > 0) {
+            sched.queue.push_back(channel);
+            sched.wake(0.0);
+            return;
+        }
+    }
+    channel->open();
+}
+
+void ConnectScheduler::prioritize(const std::shared_ptr<SharedChannel>& channel) {
+    Scheduler& sched = scheduler();
+    const std::lock_guard<std::mutex> lock(sched.mutex);
+    // Linear, but each channel is only prioritized once
+    auto it = std::find_if(sched.queue.begin(), sched.queue.end(), [&channel](const auto& queued) {
+        return !queued.owner_before(channel) && !channel.owner_before(queued);
+    });
+    if (it == sched.queue.end()) {
+        return; // already opened or being opened
+    }
+    sched.queue.erase(it);
+    sched.urgent.push_back(channel);
+    sched.wake(0.0);
+}
+
+void ConnectScheduler::connected() {
+    Scheduler& sched = scheduler();
+    const std::lock_guard<std::mutex> lock(sched.mutex);
+    sched.connected++;
+    if (sched.connected == sched.channels) {
+        sched.all_connected_ms =
+            std::chrono::duration<double, std::milli>(Scheduler::clock::now() - sched.started).count();
+    }
+    // A connecting slot may have been freed
+    if (sched.limit > 0 && (!sched.queue.empty() || !sched.urgent.empty())) {
+        sched.wake(0.0);
+    }
+}
+
+void ConnectScheduler::released(bool was_connected) {
+    Scheduler& sched = scheduler();
+    const std::lock_guard<std::mutex> lock(sched.mutex);
+    sched.channels--;
+    if (was_connected) {
+        sched.connected--;
+    } else if (sched.channels == sched.connected && sched.all_connected_ms < 0.0) {
+        sched.all_connected_ms =
+            std::chrono::duration<double, std::milli>(Scheduler::clock::now() - sched.started).count();
+    }
+}
 
-    MonitorVar incoming;
+std::shared_ptr<SharedChannel> SharedChannel::acquire(pvac::ClientProvider& provider,
+                                                      const std::string& pv_name) {
+    std::shared_ptr<SharedChannel> shared;
+    {
+        const std::lock_guard<std::mutex> lock(g_channels_mutex);
+        std::weak_ptr<SharedChannel>& entry = g_channels[Key(&provider, InternedString(pv_name))];
+        if (auto existing = entry.lock()) {
+            return existing;
+        }
+        shared.reset(new SharedChannel(provider, pv_name));
+        entry = shared;
+    }
+    ConnectScheduler::request(shared);
+    return shared;
+}
+
+size_t SharedChannel::count() {
+    const std::lock_guard<std::mutex> lock(g_channels_mutex);
+    return std::count_if(g_channels.begin(), g_channels.end(),
+                         [](const auto& entry) { return !entry.second.expired(); });
+}
+
+SharedChannel::SharedChannel(pvac::ClientProvider& provider, const std::string& pv_name)
+    : key_(&provider, InternedString(pv_name)), provider_(provider) {}
+
+void SharedChannel::open() {
+    if (open_started_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    const std::lock_guard<std::mutex> guard(monitor_mutex_);
+
+    // No callbacks can arrive before the listener is added
+    pvac::ClientChannel channel = provider_.connect(key_.second);
     {
         const std::lock_guard<std::mutex> lock(mutex_);
-        if (std::holds_alternative<std::monostate>(monitor_var_internal_))
+        channel_ = channel;
+    }
+    channel.addConnectListener(this);
+    opened_.store(true, std::memory_order_release);
+    this->update_monitor();
+}
+
+void SharedChannel::update_monitor() {
+    bool want;
+    bool running;
+    pvac::ClientChannel channel;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        // Without subscribers the channel is about to be released, leave it as it is
+        want = subscribers_.empty() ? monitor_started_ : paused_count_ < subscribers_.size();
+        running = monitor_started_;
+        channel = channel_;
+    }
+    if (want == running || !opened()) {
+        return;
+    }
+
+    if (!want) {
+        pvac::Monitor monitor;
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            monitor = monitor_;
+            monitor_ = pvac::Monitor();
+            monitor_started_ = false;
+        }
+        // Not under mutex_, cancel() waits for a running monitorEvent()
+        monitor.cancel();
+        return;
+    }
+
+    pvac::Monitor monitor = channel.monitor(this);
+    const std::lock_guard<std::mutex> lock(mutex_);
+    monitor_ = monitor;
+    monitor_started_ = true;
+    if (data_waiting_) {
+        // monitorEvent() ran before monitor_ was assigned
+        data_waiting_ = false;
+        this->drain_monitor();
+    }
+}
+
+SharedChannel::~SharedChannel() {
+    if (opened()) {
+        // No callbacks run after cancel() returns
+        if (monitor_started_) {
+            monitor_.cancel();
+        }
+        channel_.removeConnectListener(this);
+    }
+    ConnectScheduler::released(ever_connected_);
+
+    // A replacement may already have been registered under the same key
+    const std::lock_guard<std::mutex> lock(g_channels_mutex);
+    auto it = g_channels.find(key_);
+    if (it != g_channels.end() && it->second.expired()) {
+        g_channels.erase(it);
+    }
+}
+
+pvac::ClientChannel SharedChannel::channel() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return channel_;
+}
+
+void SharedChannel::prioritize() {
+    if (opened() || prioritized_.exchange(true, std::memory_order_relaxed)) {
+        return;
+    }
+    ConnectScheduler::prioritize(shared_from_this());
+}
+
+bool SharedChannel::connected_once() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return ever_connected_;
+}
+
+void SharedChannel::subscribe(PVHandler* pv) {
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        if (connect_event_.connected) {
+            pv->connection_monitor_->connectEvent(connect_event_);
+        }
+        if (latest_) {
+            epics::pvData::BitSet all;
+            all.set(0);
+            pv->receive(*latest_, all);
+            pv->flush();
+        }
+        subscribers_.push_back(pv);
+    }
+    // Restarts the monitor if every other subscriber was paused
+    const std::lock_guard<std::mutex> guard(monitor_mutex_);
+    this->update_monitor();
+}
+
+void SharedChannel::unsubscribe(PVHandler* pv) {
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        subscribers_.erase(std::remove(subscribers_.begin(), subscribers_.end(), pv), subscribers_.end());
+        if (pv->channel_paused_) {
+            pv->channel_paused_ = false;
+            paused_count_--;
+        }
+    }
+    const std::lock_guard<std::mutex> guard(monitor_mutex_);
+    this->update_monitor();
+}
+
+void SharedChannel::set_paused(PVHandler* pv, bool paused) {
+    const std::lock_guard<std::mutex> guard(monitor_mutex_);
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        if (pv->channel_paused_ == paused) {
             return;
-        incoming = monitor_var_internal_;
-    }
-
-    // get the display precision
-    constexpr int DEFAULT_PRECISION = 4;
-    static std::regex fmt_regex(R"(F\d+\.(\d+))");
-    int precision = DEFAULT_PRECISION;
-    auto display_struct = pfield->getSubField<pvd::PVStructure>("display");
-    if (display_struct) {
-        auto format_field = display_struct->getSubField<pvd::PVString>("format");
-        if (format_field) {
-            std::string prec_str = format_field->get();
-            std::smatch match;
-            if (std::regex_match(prec_str, match, fmt_regex) && match.size() == 2) {
-                precision = std::stoi(match[1]);
+        }
+        pv->channel_paused_ = paused;
+        if (paused) {
+            paused_count_++;
+        } else {
+            paused_count_--;
+            // Catch up with the updates skipped while paused
+            if (latest_) {
+                epics::pvData::BitSet all;
+                all.set(0);
+                pv->receive(*latest_, all);
+                pv->flush();
             }
         }
     }
+    this->update_monitor();
+}
 
-    bool success = false;
-    std::visit(
-        [&](auto& var) {
-            using VarType = std::decay_t<decltype(var)>;
+void SharedChannel::with_latest(const std::function<void(const epics::pvData::PVStructure*)>& func) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    func(latest_.get());
+}
 
-            if constexpr (std::is_same_v<VarType, int>) {
-                if (auto val_field = pfield->getSubFieldT<pvd::PVScalar>("value")) {
-                    var = val_field->getAs<int>();
-                    success = true;
-                };
+void SharedChannel::connectEvent(const pvac::ConnectEvent& event) {
+    bool first_connect = false;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        connect_event_ = event;
+        if (!event.connected) {
+            // Stale once the channel is down, so don't hand it to handlers or listeners
+            // added before it reconnects
+            latest_.reset();
+        }
+        if (event.connected && !ever_connected_) {
+            ever_connected_ = true;
+            first_connect = true;
+        }
+        for (PVHandler* pv : subscribers_) {
+            pv->connection_monitor_->connectEvent(event);
+            pv->signal_status_change();
+        }
+    }
+    if (first_connect) {
+        ConnectScheduler::connected();
+    }
+}
+
+void SharedChannel::monitorEvent(const pvac::MonitorEvent& evt) {
+    if (evt.event != pvac::MonitorEvent::Data) {
+        return;
+    }
+    PVTUI_TRACE("monitorEvent", key_.second.c_str());
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (!monitor_started_) {
+        data_waiting_ = true;
+        return;
+    }
+    this->drain_monitor();
+}
+
+void SharedChannel::drain_monitor() {
+    while (monitor_.poll()) {
+        // Keep the newest value for handlers which subscribe or resume later. The
+        // monitor element is returned to the queue on the next poll().
+        if (!latest_ || latest_->getStructure() != monitor_.root->getStructure()) {
+            latest_ = epics::pvData::getPVDataCreate()->createPVStructure(monitor_.root->getStructure());
+            latest_->copyUnchecked(*monitor_.root);
+        } else {
+            latest_->copyUnchecked(*monitor_.root, monitor_.changed);
+        }
+        for (PVHandler* pv : subscribers_) {
+            if (!pv->channel_paused_) {
+                pv->receive(*monitor_.root, monitor_.changed);
             }
+        }
+    }
+    for (PVHandler* pv : subscribers_) {
+        if (!pv->channel_paused_) {
+            pv->flush();
+        }
+    }
+}
+
+PVHandler::PVHandler(pvac::ClientProvider& provider, const std::string& pv_name,
+                     std::shared_ptr<UpdateNotifier> notifier, std::shared_ptr<UpdateQueue> update_queue)
+    : name(pv_name), notifier_(std::move(notifier)), update_queue_(std::move(update_queue)),
+      shared_channel_(SharedChannel::acquire(provider, pv_name)),
+      connection_monitor_(std::make_shared<ConnectionMonitor>(notifier_)) {
+    // Subscribe last so callbacks never see a partially constructed handler
+    shared_channel_->subscribe(this);
+}
+
+PVHandler::~PVHandler() {
+    // No callbacks reach this handler after unsubscribe() returns
+    shared_channel_->unsubscribe(this);
+
+    // cancel() waits for a running putDone(), which takes put_mutex_
+    pvac::Operation put_op;
+    {
+        const std::lock_guard<std::mutex> lock(put_mutex_);
+        put_op = put_op_;
+        put_waiting_.reset();
+    }
+    if (put_op.valid()) {
+        put_op.cancel();
+    }
+    if (timer_) {
+        timer_->destroy();
+        timer_queue_->release();
+    }
+
+    // Nothing can queue another decode now, but one may still be waiting for a worker
+    std::unique_lock<std::mutex> lock(pending_mutex_);
+    decode_idle_.wait(lock, [this] { return !decode_queued_; });
+}
+
+void PVHandler::add_viewer() {
+    const std::lock_guard<std::mutex> lock(view_mutex_);
+    viewers_++;
+    this->update_paused();
+}
+
+void PVHandler::remove_viewer() {
+    const std::lock_guard<std::mutex> lock(view_mutex_);
+    viewers_--;
+    this->update_paused();
+}
+
+void PVHandler::pause() {
+    const std::lock_guard<std::mutex> lock(view_mutex_);
+    pauses_++;
+    this->update_paused();
+}
+
+void PVHandler::resume() {
+    const std::lock_guard<std::mutex> lock(view_mutex_);
+    pauses_--;
+    this->update_paused();
+}
+
+bool PVHandler::paused() const {
+    const std::lock_guard<std::mutex> lock(view_mutex_);
+    return paused_;
+}
+
+void PVHandler::update_paused() {
+    const bool paused = pauses_ > 0 && pauses_ >= viewers_;
+    if (paused != paused_) {
+        paused_ = paused;
+        shared_channel_->set_paused(this, paused);
+    }
+}
+
+void PVHandler::put(const std::string& field, PutValue value) {
+    PVTUI_TRACE("put", name.c_str());
+    uint64_t seq;
+    {
+        const std::lock_guard<std::mutex> lock(put_mutex_);
+        put_status_.state = PutState::Pending;
+        if (put_in_flight_) {
+            if (put_waiting_) {
+                put_status_.coalesced++;
+            }
+            put_waiting_ = PutRequest{field, std::move(value)};
+            return;
+        }
+        put_in_flight_ = true;
+        put_sending_ = PutRequest{field, std::move(value)};
+        put_started_ = std::chrono::steady_clock::now();
+        seq = ++put_seq_;
+    }
+    this->start_put(seq);
+}
+
+void PVHandler::start_put(uint64_t seq) {
+    // Not under put_mutex_, the provider may call putBuild() before put() returns
+    pvac::Operation op;
+    try {
+        if (!shared_channel_->opened()) {
+            throw std::runtime_error(name.str() + " is not connected yet");
+        }
+        op = shared_channel_->channel().put(&put_sender_);
+    } catch (const std::exception& e) {
+        const std::lock_guard<std::mutex> lock(put_mutex_);
+        put_in_flight_ = false;
+        put_waiting_.reset(); // same as a cancelled put, see putDone()
+        put_status_.state = PutState::Failed;
+        put_status_.message = e.what();
+        put_status_.failed++;
+        return;
+    }
+
+    // Dropping the last copy of an Operation cancels it, so keep it until it completes.
+    // If it already completed and a newer put started, keep the newer one instead.
+    const std::lock_guard<std::mutex> lock(put_mutex_);
+    if (put_seq_ == seq) {
+        put_op_ = op;
+    }
+}
+
+PutStatus PVHandler::put_status() const {
+    const std::lock_guard<std::mutex> lock(put_mutex_);
+    return put_status_;
+}
+
+void PVHandler::PutSender::putBuild(const epics::pvData::StructureConstPtr&, Args& args) {
+    const std::lock_guard<std::mutex> lock(pv.put_mutex_);
+    auto field = args.root->getSubFieldT<epics::pvData::PVScalar>(pv.put_sending_.field);
+    std::visit([&field](const auto& value) { field->putFrom(value); }, pv.put_sending_.value);
+    args.tosend.set(field->getFieldOffset());
+}
+
+void PVHandler::PutSender::putDone(const pvac::PutEvent& evt) {
+    uint64_t next_seq = 0;
+    {
+        const std::lock_guard<std::mutex> lock(pv.put_mutex_);
+        pv.put_in_flight_ = false;
+        switch (evt.event) {
+        case pvac::PutEvent::Success:
+            pv.put_status_.state = PutState::Done;
+            pv.put_status_.completed++;
+            pv.put_status_.last_latency_ms =
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pv.put_started_)
+                    .count();
+            if (trace::enabled()) {
+                const uint64_t end = trace::now_ns();
+                const auto latency = std::chrono::steady_clock::now() - pv.put_started_;
+                trace::record("put round trip", pv.name.c_str(),
+                              end - std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count(), end);
+            }
+            break;
+        case pvac::PutEvent::Fail:
+            pv.put_status_.state = PutState::Failed;
+            pv.put_status_.message = evt.message;
+            pv.put_status_.failed++;
+            break;
+        case pvac::PutEvent::Cancel:
+            // Kept, the waiting value would be sent after the next put() and overwrite it
+            pv.put_waiting_.reset();
+            break;
+        }
+
+        if (evt.event != pvac::PutEvent::Cancel && pv.put_waiting_) {
+            pv.put_in_flight_ = true;
+            pv.put_sending_ = std::move(*pv.put_waiting_);
+            pv.put_waiting_.reset();
+            pv.put_started_ = std::chrono::steady_clock::now();
+            pv.put_status_.state = PutState::Pending;
+            next_seq = ++pv.put_seq_;
+        }
+    }
+    if (next_seq) {
+        pv.start_put(next_seq);
+    }
+    pv.signal_status_change();
+}
+
+void PVHandler::signal_update() {
+    new_data_.store(true, std::memory_order_release);
+    if (update_queue_) {
+        update_queue_->push(this);
+    }
+    if (notifier_) {
+        notifier_->notify();
+    }
+}
+
+void PVHandler::signal_status_change() {
+    status_changed_.store(true, std::memory_order_relaxed);
+    this->signal_update();
+}
+
+void PVHandler::set_max_rate(double hz) {
+    const std::lock_guard<std::mutex> lock(pending_mutex_);
+    coalesce_ = true;
+    if (hz > 0.0) {
+        min_decode_period_ =
+            std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / hz));
+        if (!timer_) {
+            timer_queue_ = &epicsTimerQueueActive::allocate(true);
+            timer_ = &timer_queue_->createTimer();
+            timer_notify_ = std::make_unique<RateLimitTimer>(*this);
+        }
+    } else {
+        min_decode_period_ = clock::duration::zero();
+    }
+}
+
+void PVHandler::set_decode_pool(std::shared_ptr<DecodePool> pool) {
+    const std::lock_guard<std::mutex> lock(pending_mutex_);
+    if (pool) {
+        coalesce_ = true;
+    }
+    decode_pool_ = std::move(pool);
+}
+
+size_t PVHandler::add_update_listener(UpdateListener listener) {
+    size_t id = 0;
+    // Only the new listener gets the current value. The others have seen it already.
+    shared_channel_->with_latest([&](const epics::pvData::PVStructure* latest) {
+        // Held until the listener is registered, so a rate-limited decode on the timer
+        // thread or a pool worker can't land between the check and the registration
+        const std::lock_guard<std::mutex> decode_lock(decode_mutex_);
+        bool waiting;
+        {
+            const std::lock_guard<std::mutex> lock(pending_mutex_);
+            waiting = latest_pending_ && min_decode_period_ > clock::duration::zero();
+        }
+        const std::lock_guard<std::mutex> lock(listener_mutex_);
+        id = next_listener_id_++;
+        // An update held back by the rate limit reaches the listener when it is decoded
+        if (latest && !waiting) {
+            listener(*this, *latest);
+        }
+        listeners_.emplace_back(id, std::move(listener));
+    });
+    return id;
+}
+
+void PVHandler::remove_update_listener(size_t id) {
+    const std::lock_guard<std::mutex> lock(listener_mutex_);
+    listeners_.erase(std::remove_if(listeners_.begin(), listeners_.end(),
+                                    [id](const auto& entry) { return entry.first == id; }),
+                     listeners_.end());
+}
+
+UpdateCounters PVHandler::counters() const {
+    UpdateCounters out;
+    out.received = received_.load(std::memory_order_relaxed);
+    out.decoded = decoded_.load(std::memory_order_relaxed);
+    out.coalesced = coalesced_.load(std::memory_order_relaxed);
+    out.dropped = dropped_.load(std::memory_order_relaxed);
+    out.decode_ns = decode_ns_.load(std::memory_order_relaxed);
+    return out;
+}
 
-            else if constexpr (std::is_same_v<VarType, double>) {
-                if (auto val_field = pfield->getSubFieldT<pvd::PVDouble>("value")) {
-                    var = val_field->getAs<double>();
-                    success = true;
-                };
+void PVHandler::receive(const epics::pvData::PVStructure& root, const epics::pvData::BitSet& changed) {
+    received_.fetch_add(1, std::memory_order_relaxed);
+    bool limited;
+    bool coalesce;
+    {
+        const std::lock_guard<std::mutex> lock(pending_mutex_);
+        limited = min_decode_period_ > clock::duration::zero();
+        coalesce = coalesce_;
+        if (coalesce_) {
+            if (batch_received_) {
+                coalesced_.fetch_add(1, std::memory_order_relaxed);
+            } else if (latest_pending_) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
             }
 
-            else if constexpr (std::is_same_v<VarType, std::string>) {
-                std::string type_str = pfield->getStructure()->getField("value")->getID();
-                if (type_str == "string") {
-                    if (auto val_field = pfield->getSubField<pvd::PVString>("value")) {
-                        var = val_field->getAs<std::string>();
-                        success = true;
-                    }
-                } else if (type_str == "byte[]") {
-                    pvd::shared_vector<const signed char> vals =
-                        pfield->getSubFieldT<pvd::PVByteArray>("value")->view();
-                    auto last_ind = std::find_if(vals.rbegin(), vals.rend(), [](const signed char c) {
-                        return std::isalnum(static_cast<unsigned char>(c));
-                    });
-                    var = std::string(vals.begin(), last_ind.base());
-                    success = true;
-                } else {
-                    std::ostringstream oss;
-                    oss << std::fixed << std::setprecision(precision);
-                    if (auto val_field = pfield->getSubField("value")) {
-                        val_field->dumpValue(oss);
-                        var = oss.str();
-                        success = true;
-                    }
-                }
+            // root is only valid during this call, so keep a copy to decode in flush(). Arrays
+            // share their data with root rather than being copied.
+            if (!latest_ || latest_->getStructure() != root.getStructure()) {
+                latest_ = epics::pvData::getPVDataCreate()->createPVStructure(root.getStructure());
+                latest_->copyUnchecked(root);
+                latest_changed_.clear();
+                latest_changed_.set(0); // whole structure is new
+            } else if (latest_stale_) {
+                // Holds an older update after decode_pending() swapped it out, but root
+                // always holds the complete current value
+                latest_->copyUnchecked(root);
+                latest_changed_ |= changed;
+            } else {
+                latest_->copyUnchecked(root, changed);
+                latest_changed_ |= changed;
             }
+            latest_stale_ = false;
+            latest_pending_ = true;
+            batch_received_ = true;
+        }
+    }
+
+    // Listeners see every update, including those merged above. Only a rate limit skips
+    // updates, and then they see the decoded ones.
+    if (!limited) {
+        this->notify_listeners(root);
+    }
+    if (coalesce) {
+        return;
+    }
+    const std::lock_guard<std::mutex> lock(decode_mutex_);
+    decoded_.fetch_add(1, std::memory_order_relaxed);
+    this->get_monitored_variable(&root, changed);
+}
+
+void PVHandler::flush() {
+    {
+        const std::lock_guard<std::mutex> lock(pending_mutex_);
+        if (!batch_received_) {
+            return;
+        }
+        batch_received_ = false;
+        if (!this->decode_due()) {
+            return;
+        }
+        if (decode_pool_) {
+            this->queue_decode();
+            return;
+        }
+    }
+    this->decode_pending();
+}
+
+bool PVHandler::decode_due() {
+    const auto now = clock::now();
+    if (now >= next_decode_) {
+        return true;
+    }
+    if (!timer_armed_) {
+        timer_armed_ = true;
+        timer_->start(*timer_notify_, std::chrono::duration<double>(next_decode_ - now).count());
+    }
+    return false;
+}
+
+void PVHandler::queue_decode() {
+    // One decode in flight per handler keeps updates in order; later ones merge into latest_
+    if (!decode_queued_) {
+        decode_queued_ = true;
+        decode_pool_->submit([this] { this->run_queued_decode(); });
+    }
+}
+
+void PVHandler::decode_pending() {
+    const std::lock_guard<std::mutex> lock(decode_mutex_);
+    bool limited;
+    {
+        const std::lock_guard<std::mutex> pending_lock(pending_mutex_);
+        if (!latest_pending_) {
+            return;
+        }
+        std::swap(latest_, decoding_);
+        decoding_changed_ = latest_changed_;
+        latest_changed_.clear();
+        latest_stale_ = true;
+        latest_pending_ = false;
+        limited = min_decode_period_ > clock::duration::zero();
+        if (limited) {
+            next_decode_ = clock::now() + min_decode_period_;
+        }
+    }
+    decoded_.fetch_add(1, std::memory_order_relaxed);
+    if (limited) {
+        this->notify_listeners(*decoding_);
+    }
+    this->get_monitored_variable(decoding_.get(), decoding_changed_);
+}
+
+void PVHandler::run_queued_decode() {
+    this->decode_pending();
+
+    const std::lock_guard<std::mutex> lock(pending_mutex_);
+    // Updates merged meanwhile found this decode still queued, so queue one for them
+    if (latest_pending_ && decode_pool_ && this->decode_due()) {
+        decode_pool_->submit([this] { this->run_queued_decode(); });
+        return;
+    }
+    decode_queued_ = false;
+    decode_idle_.notify_all();
+}
+
+epicsTimerNotify::expireStatus PVHandler::RateLimitTimer::expire(const epicsTime&) {
+    {
+        const std::lock_guard<std::mutex> lock(pv.pending_mutex_);
+        pv.timer_armed_ = false;
+        if (!pv.latest_pending_) {
+            return expireStatus(noRestart);
+        }
+        if (pv.decode_pool_) {
+            pv.queue_decode();
+            return expireStatus(noRestart);
+        }
+    }
+    pv.decode_pending();
+    return expireStatus(noRestart);
+}
+
+void PVHandler::process_update(const epics::pvData::PVStructure& root,
+                               const epics::pvData::BitSet& changed) {
+    this->receive(root, changed);
+    this->flush();
+}
+
+bool PVHandler::connected() const { return connection_monitor_->connected(); }
+
+std::optional<int> parse_format_precision(std::string_view format) {
+    // Equivalent to matching F\d+\.(\d+)
+    auto is_digit = [](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; };
+    if (format.size() < 4 || format[0] != 'F') {
+        return std::nullopt;
+    }
+    size_t dot = 1;
+    while (dot < format.size() && is_digit(format[dot])) {
+        dot++;
+    }
+    if (dot == 1 || dot + 1 >= format.size() || format[dot] != '.') {
+        return std::nullopt;
+    }
+    const char* first = format.data() + dot + 1;
+    const char* last = format.data() + format.size();
+    if (!std::all_of(first, last, is_digit)) {
+        return std::nullopt;
+    }
+    int precision = 0;
+    if (std::from_chars(first, last, precision).ec != std::errc()) {
+        return std::nullopt;
+    }
+    return precision;
+}
 
-            else if constexpr (std::is_same_v<VarType, PVEnum>) {
-                pvd::shared_vector<const std::string> choices =
-                    pfield->getSubFieldT<pvd::PVStringArray>("value.choices")->view();
-                size_t index = pfield->getSubFieldT<pvd::PVInt>("value.index")->getAs<int>();
-                if (choices.size() > index) {
-                    var.index = index;
-                    var.choice = choices.at(index);
-                    if (var.choices.size() != choices.size()) {
-                        var.choices.resize(choices.size());
-                    }
-                    std::copy(choices.begin(), choices.end(), var.choices.begin());
-                    success = true;
-                }
+namespace {
+// Appends a number as std::ostream does with std::fixed. A buffer this size holds any
+// integer and the typical floating point value; larger ones fail and use the stream.
+template <typename T> bool append_number(std::string& out, T value, int precision) {
+    char buf[64];
+    std::to_chars_result result;
+    if constexpr (std::is_floating_point_v<T>) {
+        // A float is widened to double by the stream too
+        result = std::to_chars(buf, buf + sizeof(buf), static_cast<double>(value), std::chars_format::fixed,
+                               precision);
+    } else if constexpr (sizeof(T) == 1) {
+        // dumpValue prints int8 and uint8 as numbers rather than characters
+        result = std::to_chars(buf, buf + sizeof(buf), static_cast<int>(value));
+    } else {
+        result = std::to_chars(buf, buf + sizeof(buf), value);
+    }
+    if (result.ec != std::errc()) {
+        return false;
+    }
+    out.append(buf, result.ptr);
+    return true;
+}
+
+// Arrays are written as [a,b,c] like PVValueArray::dumpValue
+template <typename T>
+bool append_values(std::string& out, const epics::pvData::PVField& field, bool array, int precision) {
+    namespace pvd = epics::pvData;
+    if (!array) {
+        return append_number(out, static_cast<const pvd::PVScalarValue<T>&>(field).get(), precision);
+    }
+    const pvd::shared_vector<const T> vals = static_cast<const pvd::PVValueArray<T>&>(field).view();
+    out.push_back('[');
+    for (size_t i = 0; i < vals.size(); i++) {
+        if (i) {
+            out.push_back(',');
+        }
+        if (!append_number(out, vals[i], precision)) {
+            return false;
+        }
+    }
+    out.push_back(']');
+    return true;
+}
+} // namespace
+
+bool format_value(const epics::pvData::PVField& field, int precision, std::string& out) {
+    namespace pvd = epics::pvData;
+    const pvd::Type type = field.getField()->getType();
+    pvd::ScalarType scalar_type;
+    if (type == pvd::scalar) {
+        scalar_type = static_cast<const pvd::PVScalar&>(field).getScalar()->getScalarType();
+    } else if (type == pvd::scalarArray) {
+        scalar_type = static_cast<const pvd::PVScalarArray&>(field).getScalarArray()->getElementType();
+    } else {
+        return false;
+    }
+    const bool array = type == pvd::scalarArray;
+    if (precision < 0) {
+        precision = 6; // printf's default, which the stream also falls back to
+    }
+
+    out.clear();
+    switch (scalar_type) {
+    case pvd::pvByte:
+        return append_values<pvd::int8>(out, field, array, precision);
+    case pvd::pvShort:
+        return append_values<pvd::int16>(out, field, array, precision);
+    case pvd::pvInt:
+        return append_values<pvd::int32>(out, field, array, precision);
+    case pvd::pvLong:
+        return append_values<pvd::int64>(out, field, array, precision);
+    case pvd::pvUByte:
+        return append_values<pvd::uint8>(out, field, array, precision);
+    case pvd::pvUShort:
+        return append_values<pvd::uint16>(out, field, array, precision);
+    case pvd::pvUInt:
+        return append_values<pvd::uint32>(out, field, array, precision);
+    case pvd::pvULong:
+        return append_values<pvd::uint64>(out, field, array, precision);
+    case pvd::pvFloat:
+        return append_values<float>(out, field, array, precision);
+    case pvd::pvDouble:
+        return append_values<double>(out, field, array, precision);
+    default:
+        // Booleans and strings keep dumpValue's own formatting
+        return false;
+    }
+}
+
+namespace {
+// True if field, one of its subfields, or a structure containing it is marked as changed
+bool field_changed(const epics::pvData::PVField& field, const epics::pvData::BitSet& changed) {
+    const epics::pvData::int32 next = changed.nextSetBit(field.getFieldOffset());
+    if (next >= 0 && static_cast<size_t>(next) < field.getNextFieldOffset()) {
+        return true;
+    }
+    for (const epics::pvData::PVField* parent = field.getParent(); parent; parent = parent->getParent()) {
+        if (changed.get(parent->getFieldOffset())) {
+            return true;
+        }
+    }
+    return false;
+}
+} // namespace
+
+PVMetadata PVHandler::metadata() const {
+    const std::lock_guard<std::mutex> lock(metadata_mutex_);
+    return metadata_;
+}
+
+void PVHandler::update_metadata(const epics::pvData::PVStructure* pfield,
+                                const epics::pvData::BitSet& changed) {
+    namespace pvd = epics::pvData;
+
+    auto display = pfield->getSubField<pvd::PVStructure>("display");
+    auto control = pfield->getSubField<pvd::PVStructure>("control");
+    const bool display_changed = display && field_changed(*display, changed);
+    const bool control_changed = control && field_changed(*control, changed);
+    if (!display_changed && !control_changed) {
+        return;
+    }
+
+    auto get_string = [](const pvd::PVStructure& s, const char* name, std::string& out) {
+        if (auto f = s.getSubField<pvd::PVString>(name)) {
+            out = f->get();
+        }
+    };
+    auto get_double = [](const pvd::PVStructure& s, const char* name, double& out) {
+        if (auto f = s.getSubField<pvd::PVScalar>(name)) {
+            out = f->getAs<double>();
+        }
+    };
+
+    const std::lock_guard<std::mutex> lock(metadata_mutex_);
+    if (display_changed) {
+        get_string(*display, "format", metadata_.format);
+        get_string(*display, "units", metadata_.units);
+        get_string(*display, "description", metadata_.description);
+        get_double(*display, "limitLow", metadata_.display_low);
+        get_double(*display, "limitHigh", metadata_.display_high);
+        metadata_.precision =
+            parse_format_precision(metadata_.format).value_or(PVMetadata::DEFAULT_PRECISION);
+        precision_ = metadata_.precision;
+    }
+    if (control_changed) {
+        get_double(*control, "limitLow", metadata_.control_low);
+        get_double(*control, "limitHigh", metadata_.control_high);
+    }
+}
+
+namespace {
+// Decodes the value field of pfield into var. Returns false if it could not be decoded.
+template <typename VarType>
+bool decode_value(const epics::pvData::PVStructure* pfield, VarType& var, int precision) {
+    namespace pvd = epics::pvData;
+
+
+    if constexpr (std::is_same_v<VarType, int>) {
+        if (auto val_field = pfield->getSubFieldT<pvd::PVScalar>("value")) {
+            var = val_field->getAs<int>();
+            return true;
+        }
+    }
+
+    else if constexpr (std::is_same_v<VarType, double>) {
+        if (auto val_field = pfield->getSubFieldT<pvd::PVScalar>("value")) {
+            var = val_field->getAs<double>();
+            return true;
+        }
+    }
+
+    else if constexpr (std::is_same_v<VarType, std::string>) {
+        std::string type_str = pfield->getStructure()->getField("value")->getID();
+        if (type_str == "string") {
+            if (auto val_field = pfield->getSubField<pvd::PVString>("value")) {
+                var = val_field->getAs<std::string>();
+                return true;
+            }
+        } else if (type_str == "byte[]") {
+            pvd::shared_vector<const signed char> vals =
+                pfield->getSubFieldT<pvd::PVByteArray>("value")->view();
+            auto last_ind = std::find_if(vals.rbegin(), vals.rend(), [](const signed char c) {
+                return std::isalnum(static_cast<unsigned char>(c));
+            });
+            var = std::string(vals.begin(), last_ind.base());
+            return true;
+        } else if (auto val_field = pfield->getSubField("value")) {
+            if (!format_value(*val_field, precision, var)) {
+                std::ostringstream oss;
+                oss << std::fixed << std::setprecision(precision);
+                val_field->dumpValue(oss);
+                var = oss.str();
             }
+            return true;
+        }
+    }
 
-            else if constexpr (std::is_same_v<VarType, std::vector<double>>) {
-                pvd::shared_vector<const double> vals =
-                    pfield->getSubFieldT<pvd::PVDoubleArray>("value")->view();
-                if (var.size() != vals.size()) {
-                    var.resize(vals.size());
-                }
-                std::copy(vals.begin(), vals.end(), var.begin());
-                success = true;
+    else if constexpr (std::is_same_v<VarType, PVEnum>) {
+        pvd::shared_vector<const std::string> choices =
+            pfield->getSubFieldT<pvd::PVStringArray>("value.choices")->view();
+        size_t index = pfield->getSubFieldT<pvd::PVInt>("value.index")->getAs<int>();
+        if (choices.size() > index) {
+            var.index = index;
+            var.choice = choices.at(index);
+            // Comparing keeps the shared list without allocating when the choices are unchanged
+            const std::vector<std::string>& current = *var.choices;
+            if (current.size() != choices.size() ||
+                !std::equal(choices.begin(), choices.end(), current.begin())) {
+                var.choices = intern_choices(choices.data(), choices.size());
             }
+            return true;
+        }
+    }
+
+    else if constexpr (std::is_same_v<VarType, std::vector<double>>) {
+        pvd::shared_vector<const double> vals =
+            pfield->getSubFieldT<pvd::PVDoubleArray>("value")->view();
+        if (var.size() != vals.size()) {
+            var.resize(vals.size());
+        }
+        std::copy(vals.begin(), vals.end(), var.begin());
+        return true;
+    }
+
+    else if constexpr (std::is_same_v<VarType, std::vector<int>>) {
+        pvd::shared_vector<const int> vals = pfield->getSubFieldT<pvd::PVIntArray>("value")->view();
+        if (var.size() != vals.size()) {
+            var.resize(vals.size());
+        }
+        std::copy(vals.begin(), vals.end(), var.begin());
+        return true;
+    }
+
+    else if constexpr (std::is_same_v<VarType, SharedArray<double>> ||
+                       std::is_same_v<VarType, SharedArray<int>>) {
+        // Shares the received array when the element types match, converts otherwise
+        if (auto val_field = pfield->getSubField<pvd::PVScalarArray>("value")) {
+            val_field->getAs(var);
+            return true;
+        }
+    }
+
+    else if constexpr (std::is_same_v<VarType, std::vector<std::string>>) {
+        pvd::shared_vector<const std::string> vals =
+            pfield->getSubFieldT<pvd::PVStringArray>("value")->view();
+        if (var.size() != vals.size()) {
+            var.resize(vals.size());
+        }
+        std::copy(vals.begin(), vals.end(), var.begin());
+        return true;
+    }
+
+    else {
+        // unsupported type
+    }
+    return false;
+}
+} // namespace
+
+const char* alarm_severity_name(AlarmSeverity severity) {
+    switch (severity) {
+    case AlarmSeverity::NoAlarm:
+        return "NO_ALARM";
+    case AlarmSeverity::Minor:
+        return "MINOR";
+    case AlarmSeverity::Major:
+        return "MAJOR";
+    case AlarmSeverity::Invalid:
+        break;
+    }
+    return "INVALID";
+}
+
+namespace {
+// Decodes the alarm and timeStamp fields of pfield, leaving the defaults for missing fields
+void decode_alarm(const epics::pvData::PVStructure* pfield, PVAlarm& alarm, PVTimeStamp& timestamp) {
+    namespace pvd = epics::pvData;
+    if (auto severity = pfield->getSubField<pvd::PVScalar>("alarm.severity")) {
+        const int value = severity->getAs<pvd::int32>();
+        alarm.severity = value >= 0 && value <= static_cast<int>(AlarmSeverity::Invalid)
+                             ? static_cast<AlarmSeverity>(value)
+                             : AlarmSeverity::Invalid;
+    }
+    if (auto status = pfield->getSubField<pvd::PVScalar>("alarm.status")) {
+        alarm.status = status->getAs<pvd::int32>();
+    }
+    if (auto message = pfield->getSubField<pvd::PVString>("alarm.message")) {
+        alarm.message = message->get();
+    }
+    if (auto seconds = pfield->getSubField<pvd::PVScalar>("timeStamp.secondsPastEpoch")) {
+        timestamp.seconds = seconds->getAs<pvd::int64>();
+    }
+    if (auto nanoseconds = pfield->getSubField<pvd::PVScalar>("timeStamp.nanoseconds")) {
+        timestamp.nanoseconds = nanoseconds->getAs<pvd::int32>();
+    }
+}
+} // namespace
+
+template <typename T> class PVHandler::TypedSlot final : public PVHandler::SlotBase {
+  public:
+    bool decode(const epics::pvData::PVStructure* pfield, int precision) override {
+        return decode_value(pfield, values_.write_buffer().value, precision);
+    }
+
+    void set_alarm(const PVAlarm& alarm, const PVTimeStamp& timestamp) override {
+        Sample& sample = values_.write_buffer();
+        sample.alarm = alarm;
+        sample.timestamp = timestamp;
+    }
+
+    void publish() override { values_.publish(); }
 
-            else if constexpr (std::is_same_v<VarType, std::vector<int>>) {
-                pvd::shared_vector<const int> vals = pfield->getSubFieldT<pvd::PVIntArray>("value")->view();
-                if (var.size() != vals.size()) {
-                    var.resize(vals.size());
-                }
-                std::copy(vals.begin(), vals.end(), var.begin());
-                success = true;
+    bool sync() override {
+        if (!values_.update()) {
+            return false;
+        }
+        const Sample& sample = values_.read_buffer();
+        for (T* var : vars_) {
+            *var = sample.value;
+        }
+        for (Monitored<T>* var : monitored_) {
+            var->value = sample.value;
+            var->alarm = sample.alarm;
+            var->timestamp = sample.timestamp;
+        }
+        return true;
+    }
+
+    void add(T* var, Monitored<T>* monitored) {
+        if (var) {
+            vars_.push_back(var);
+        }
+        if (monitored) {
+            monitored_.push_back(monitored);
+        }
+    }
+
+  private:
+    // The alarm and timestamp are only set if the slot is in alarm_types_
+    struct Sample {
+        T value{};
+        PVAlarm alarm;
+        PVTimeStamp timestamp;
+    };
+
+    TripleBuffer<Sample> values_;           // written by the decode thread, read by sync()
+    std::vector<T*> vars_;                  // registered with set_monitor(T&)
+    std::vector<Monitored<T>*> monitored_;  // registered with set_monitor(Monitored<T>&)
+};
+
+template <typename T> void PVHandler::add_monitor(T* var, Monitored<T>* monitored) {
+    const size_t index = MonitorVar(std::in_place_type<T>).index();
+    const uint32_t bit = 1u << index;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+
+        // The decode thread only touches a slot once its bit is set
+        if (!slots_[index]) {
+            slots_[index] = std::make_unique<TypedSlot<T>>();
+            active_types_.fetch_or(bit, std::memory_order_release);
+        }
+        static_cast<TypedSlot<T>&>(*slots_[index]).add(var, monitored);
+        if (monitored) {
+            alarm_types_.fetch_or(bit, std::memory_order_release);
+        }
+    }
+
+    // The channel may have received its value before this handler existed. Only the new
+    // slot is seeded, so listeners and counters don't see the value twice.
+    if (shared_channel_) {
+        shared_channel_->with_latest([this, bit](const epics::pvData::PVStructure* latest) {
+            if (!latest) {
+                return;
+            }
+            const std::lock_guard<std::mutex> lock(decode_mutex_);
+            if (this->decode_slots(latest, bit)) {
+                this->signal_update();
             }
+        });
+    }
+}
+
+// Every MonitorVar alternative, see is_monitor_type_v
+template void PVHandler::add_monitor(std::string*, Monitored<std::string>*);
+template void PVHandler::add_monitor(int*, Monitored<int>*);
+template void PVHandler::add_monitor(double*, Monitored<double>*);
+template void PVHandler::add_monitor(std::vector<std::string>*, Monitored<std::vector<std::string>>*);
+template void PVHandler::add_monitor(std::vector<int>*, Monitored<std::vector<int>>*);
+template void PVHandler::add_monitor(std::vector<double>*, Monitored<std::vector<double>>*);
+template void PVHandler::add_monitor(PVEnum*, Monitored<PVEnum>*);
+template void PVHandler::add_monitor(SharedArray<double>*, Monitored<SharedArray<double>>*);
+template void PVHandler::add_monitor(SharedArray<int>*, Monitored<SharedArray<int>>*);
+static_assert(std::variant_size_v<MonitorVar> == 10, "Instantiate add_monitor() for new MonitorVar types");
+
+void PVHandler::get_monitored_variable(const epics::pvData::PVStructure* pfield,
+                                       const epics::pvData::BitSet& changed) {
+    PVTUI_TRACE("decode", name.c_str());
+    // Metadata is usually only sent with the first update, so parse it even if
+    // no monitor has been set yet
+    this->update_metadata(pfield, changed);
+
+    const uint32_t active = active_types_.load(std::memory_order_acquire);
+    if (active == 0) {
+        return;
+    }
 
-            else if constexpr (std::is_same_v<VarType, std::vector<std::string>>) {
-                pvd::shared_vector<const std::string> vals =
-                    pfield->getSubFieldT<pvd::PVStringArray>("value")->view();
-                if (var.size() != vals.size()) {
-                    var.resize(vals.size());
-                }
-                std::copy(vals.begin(), vals.end(), var.begin());
-                success = true;
+    const auto start = std::chrono::steady_clock::now();
+    const bool published = this->decode_slots(pfield, active);
+    decode_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - start)
+                             .count(),
+                         std::memory_order_relaxed);
+    if (published) {
+        this->signal_update();
+    }
+}
+
+void PVHandler::notify_listeners(const epics::pvData::PVStructure& root) {
+    const std::lock_guard<std::mutex> lock(listener_mutex_);
+    for (const auto& [id, listener] : listeners_) {
+        listener(*this, root);
+    }
+}
+
+bool PVHandler::decode_slots(const epics::pvData::PVStructure* pfield, uint32_t types) {
+    // Decode once for each type. Only the holder of decode_mutex_ touches the write
+    // buffers, which hold an older value, so decoding reuses their allocations.
+    const int precision = precision_;
+    uint32_t decoded = 0;
+    for (size_t i = 0; i < slots_.size(); i++) {
+        if (types & (1u << i)) {
+            if (slots_[i]->decode(pfield, precision)) {
+                decoded |= 1u << i;
             }
+        }
+    }
 
-            else {
-                // unsupported type
-                success = false;
+    const uint32_t with_alarm = decoded & alarm_types_.load(std::memory_order_acquire);
+    if (with_alarm) {
+        PVTimeStamp timestamp;
+        decode_alarm(pfield, alarm_, timestamp);
+        for (size_t i = 0; i < slots_.size(); i++) {
+            if (with_alarm & (1u << i)) {
+                slots_[i]->set_alarm(alarm_, timestamp);
             }
-        },
-        incoming);
+        }
+    }
 
-    if (success) {
-        {
-            const std::lock_guard<std::mutex> lock(mutex_);
-            monitor_var_internal_ = std::move(incoming);
+    for (size_t i = 0; i < slots_.size(); i++) {
+        if (decoded & (1u << i)) {
+            slots_[i]->publish();
         }
-        new_data_.store(true, std::memory_order_release);
     }
+    return decoded != 0;
 }
 
 bool PVHandler::sync() {
-    if (!new_data_.load(std::memory_order_acquire))
+    if (!new_data_.exchange(false, std::memory_order_acquire))
         return false;
 
+    // Only set_monitor() takes this lock too, the decode thread never waits for sync()
     const std::lock_guard<std::mutex> lock(mutex_);
-    for (auto& task : sync_tasks_) {
-        task(monitor_var_internal_);
+    const uint32_t active = active_types_.load(std::memory_order_acquire);
+    bool updated = false;
+    for (size_t i = 0; i < slots_.size(); i++) {
+        if (active & (1u << i)) {
+            updated |= slots_[i]->sync();
+        }
     }
-
-    new_data_.store(false, std::memory_order_relaxed);
+    // new_data_ may be left over from a value an earlier sync() already took, since the
+    // decode thread publishes before it sets the flag
+    if (!status_changed_.exchange(false, std::memory_order_relaxed) && !updated) {
+        return false;
+    }
+    generation_.fetch_add(1, std::memory_order_relaxed);
     return true;
 }
 
 PVGroup::PVGroup(pvac::ClientProvider& provider, const std::vector<std::string>& pv_names)
-    : provider_(provider) {
+    : notifier_(std::make_shared<UpdateNotifier>()), update_queue_(std::make_shared<UpdateQueue>()),
+      provider_(provider) {
     for (const auto& name : pv_names) {
         this->add(name);
     }
 }
 
-PVGroup::PVGroup(pvac::ClientProvider& provider) : provider_(provider) {}
+PVGroup::PVGroup(pvac::ClientProvider& provider)
+    : notifier_(std::make_shared<UpdateNotifier>()), update_queue_(std::make_shared<UpdateQueue>()),
+      provider_(provider) {}
 
 void PVGroup::add(const std::string& pv_name) {
     std::lock_guard<std::mutex> lock(mutex_);
     if (!pv_map.count(pv_name)) {
-        pv_map.emplace(pv_name, std::make_shared<PVHandler>(provider_, pv_name));
+        auto pv = std::make_shared<PVHandler>(provider_, pv_name, notifier_, update_queue_);
+        if (decode_pool_) {
+            pv->set_decode_pool(decode_pool_);
+        }
+        pv_map.emplace(pv->name.view(), pv);
+    }
+}
+
+void PVGroup::set_decode_pool(std::shared_ptr<DecodePool> pool) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    decode_pool_ = pool;
+    for (auto& [name, pv] : pv_map) {
+        pv->set_decode_pool(pool);
     }
 }
 
@@ -213,13 +1488,13 @@ std::shared_ptr<PVHandler> PVGroup::get_pv_shared(const std::string& pv_name) {
 PVHandler& PVGroup::operator[](const std::string& pv_name) { return this->get_pv(pv_name); }
 
 bool PVGroup::sync() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    PVTUI_TRACE("PVGroup::sync");
     bool new_data = false;
-    for (auto& [name, pv] : pv_map) {
-        if (pv->sync()) {
+    update_queue_->drain([&new_data](PVHandler& pv) {
+        if (pv.sync()) {
             new_data = true;
         }
-    }
+    });
     return new_data;
 }
 } // namespace pvtui
@@ -1,35 +1,366 @@
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include <epicsTimer.h>
 #include <pv/caProvider.h>
 #include <pva/client.h>
 
+#include <pvtui/intern.hpp>
+
 namespace pvtui {
 
+class DecodePool;
+
 /**
  * @brief Represents the state of an EPICS enumeration (e.g., mbbo/mbbi).
+ *
+ * The choices rarely change, so they are interned and shared rather than copied with
+ * every update. The list is only replaced when the server sends different choices.
  */
 struct PVEnum {
-    int index = 0;                    ///< The current integer index of the selected choice.
-    std::vector<std::string> choices; ///< The list of all available string choices for the enum.
-    std::string choice = "";          ///< The string value of the currently selected choice.
+    int index = 0;                        ///< The current integer index of the selected choice.
+    ChoiceList choices = empty_choices(); ///< The list of all available string choices. Never null.
+    std::string choice = "";              ///< The string value of the currently selected choice.
+};
+
+/**
+ * @brief EPICS alarm severity.
+ */
+enum class AlarmSeverity {
+    NoAlarm = 0, ///< NO_ALARM
+    Minor = 1,   ///< MINOR
+    Major = 2,   ///< MAJOR
+    Invalid = 3, ///< INVALID, also used for undefined severities
+};
+
+/**
+ * @brief Gets the EPICS name of an alarm severity.
+ * @param severity The severity.
+ * @return "NO_ALARM", "MINOR", "MAJOR", or "INVALID".
+ */
+const char* alarm_severity_name(AlarmSeverity severity);
+
+/**
+ * @brief The alarm of a PV, from its alarm field.
+ */
+struct PVAlarm {
+    AlarmSeverity severity = AlarmSeverity::NoAlarm; ///< alarm.severity
+    int status = 0;                                  ///< alarm.status
+    std::string message;                             ///< alarm.message, e.g. "HIHI" over Channel Access.
+};
+
+/**
+ * @brief The server timestamp of a PV, from its timeStamp field.
+ */
+struct PVTimeStamp {
+    int64_t seconds = 0;     ///< timeStamp.secondsPastEpoch, since the POSIX epoch.
+    int32_t nanoseconds = 0; ///< timeStamp.nanoseconds
+
+    /**
+     * @brief Gets the timestamp as a floating point number.
+     * @return Seconds since the POSIX epoch.
+     */
+    double to_double() const { return static_cast<double>(seconds) + nanoseconds * 1e-9; }
+};
+
+/**
+ * @brief A monitored value together with the alarm and timestamp of the same update.
+ *
+ * Pass a Monitored<T> to PVHandler::set_monitor() instead of a T to also get the alarm
+ * severity, status, and server timestamp, so a separate .SEVR or .STAT PV isn't needed.
+ * The alarm and timestamp are only decoded for PVs monitored this way.
+ *
+ * The alarm only refreshes when the monitored field posts an update. A record's VAL
+ * field posts on every alarm change, but other fields, e.g. ERRS of an asyn record, may
+ * not, and then the separate .SEVR and .STAT PVs are still needed.
+ * @tparam T Any type which can be passed to set_monitor() itself.
+ */
+template <typename T> struct Monitored {
+    using value_type = T;
+
+    T value{};             ///< The monitored value.
+    PVAlarm alarm;         ///< Alarm of the update which set value.
+    PVTimeStamp timestamp; ///< Server timestamp of the update which set value.
+};
+
+/**
+ * @brief Display and control metadata of a PV.
+ *
+ * Parsed from the display and control substructures of the PV when they change,
+ * rather than on every monitor update.
+ */
+struct PVMetadata {
+    static constexpr int DEFAULT_PRECISION = 4; ///< Precision used when display.format has none.
+
+    int precision = DEFAULT_PRECISION; ///< Display precision, e.g. 3 for a format of "F8.3".
+    std::string format;                ///< display.format
+    std::string units;                 ///< display.units
+    std::string description;           ///< display.description
+    double display_low = 0.0;          ///< display.limitLow
+    double display_high = 0.0;         ///< display.limitHigh
+    double control_low = 0.0;          ///< control.limitLow
+    double control_high = 0.0;         ///< control.limitHigh
+};
+
+/**
+ * @brief Parses the precision from a display format string such as "F8.3".
+ * @param format The display format, of the form F<width>.<precision>.
+ * @return The precision, or std::nullopt if the format doesn't match.
+ */
+std::optional<int> parse_format_precision(std::string_view format);
+
+/**
+ * @brief Formats a numeric scalar or array field exactly as PVField::dumpValue() does on a
+ * stream set to std::fixed and the given precision.
+ *
+ * Uses std::to_chars, so there is no stream or locale lookup, and writes into out in
+ * place, so a string reused across updates doesn't allocate once it has grown.
+ * @param field The field, e.g. the value field of an update.
+ * @param precision Digits after the decimal point for floating point values.
+ * @param out Receives the text, replacing its contents.
+ * @return False if the field isn't a numeric scalar or array, or a number doesn't fit the
+ * internal buffer. out is then unspecified and dumpValue() should be used instead.
+ */
+bool format_value(const epics::pvData::PVField& field, int precision, std::string& out);
+
+/**
+ * @brief Counters describing how a PVHandler processed the monitor updates it received.
+ */
+struct UpdateCounters {
+    uint64_t received = 0;  ///< Monitor updates received from the server.
+    uint64_t decoded = 0;   ///< Updates decoded into the internal monitored value.
+    uint64_t coalesced = 0; ///< Updates skipped because a newer update was already queued.
+    uint64_t dropped = 0;   ///< Updates skipped to stay under the maximum update rate.
+    uint64_t decode_ns = 0; ///< Total time spent decoding updates, in nanoseconds.
+};
+
+/**
+ * @brief A value written to a PV field with PVHandler::put().
+ */
+using PutValue = std::variant<int, double, std::string>;
+
+/**
+ * @brief State of the most recent put to a PV.
+ */
+enum class PutState {
+    Idle,    ///< No put has been made.
+    Pending, ///< A put is in flight or waiting for the previous one to finish.
+    Done,    ///< The last put completed successfully.
+    Failed,  ///< The last put failed, see PutStatus::message.
+};
+
+/**
+ * @brief Status of the puts made with PVHandler::put().
+ */
+struct PutStatus {
+    PutState state = PutState::Idle; ///< State of the most recent put.
+    std::string message;             ///< Error message of the last failed put.
+    uint64_t completed = 0;          ///< Puts which completed successfully.
+    uint64_t failed = 0;             ///< Puts which failed.
+    uint64_t coalesced = 0;          ///< Puts replaced by a newer put before being sent.
+    double last_latency_ms = 0.0;    ///< Round trip time of the last completed put.
 };
 
 /**
- * @brief A variant type that holds a pointer to a variable monitored by a PV.
+ * @brief Immutable, reference-counted array which shares the PV's data instead of copying it.
+ *
+ * Monitoring an array PV with SharedArray<double> or SharedArray<int> avoids copying the
+ * elements on every update. The data is never modified after it is received, so it is safe
+ * to read from the UI thread while new updates arrive.
+ * @tparam T The element type.
+ */
+template <typename T> using SharedArray = epics::pvData::shared_vector<const T>;
+
+/**
+ * @brief The types which can be monitored with PVHandler::set_monitor().
  *
- * This allows a single mechanism to update variables of different types.
+ * Its alternatives also number the per-type slots of a PVHandler, which are otherwise
+ * typed at compile time, so no variant is visited for each update.
  */
 using MonitorVar = std::variant<std::monostate, std::string, int, double, std::vector<std::string>,
-                                std::vector<int>, std::vector<double>, PVEnum>;
+                                std::vector<int>, std::vector<double>, PVEnum, SharedArray<double>,
+                                SharedArray<int>>;
+
+/// @cond
+template <typename T, typename Variant> struct is_variant_alternative : std::false_type {};
+template <typename T, typename... Ts>
+struct is_variant_alternative<T, std::variant<Ts...>> : std::disjunction<std::is_same<T, Ts>...> {};
+/// @endcond
+
+/**
+ * @brief True for the types which can be monitored, the alternatives of MonitorVar.
+ */
+template <typename T>
+inline constexpr bool is_monitor_type_v =
+    is_variant_alternative<T, MonitorVar>::value && !std::is_same_v<T, std::monostate>;
+
+/**
+ * @brief Wakes up a waiting thread when monitored PVs receive new data.
+ *
+ * Notifications from the PVA callback threads are coalesced so that at most one
+ * wakeup is pending at any time. The waiting thread blocks on fd() (e.g. with poll())
+ * and calls clear() before reading the new data.
+ */
+class UpdateNotifier {
+  public:
+    /**
+     * @brief Constructs an UpdateNotifier.
+     * @throws std::runtime_error if the underlying file descriptor cannot be created.
+     */
+    UpdateNotifier();
+
+    /**
+     * @brief Destroys the UpdateNotifier and closes its file descriptors.
+     */
+    ~UpdateNotifier();
+
+    UpdateNotifier(const UpdateNotifier&) = delete;
+    UpdateNotifier& operator=(const UpdateNotifier&) = delete;
+
+    /**
+     * @brief Signals the waiting thread. Safe to call from any thread.
+     */
+    void notify();
+
+    /**
+     * @brief Acknowledges a pending notification so the next notify() wakes the waiter again.
+     */
+    void clear();
+
+    /**
+     * @brief Checks if a notification is pending, i.e. notify() was called since the last clear().
+     * @return True if a notification is pending.
+     */
+    bool pending() const { return pending_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Gets the file descriptor which becomes readable while a notification is pending.
+     * @return A file descriptor suitable for poll() or select().
+     */
+    int fd() const { return read_fd_; }
+
+  private:
+    std::atomic<bool> pending_{false}; ///< True while a wakeup has been written but not cleared.
+    int read_fd_ = -1;                 ///< Readable end (eventfd on Linux, pipe elsewhere).
+    int write_fd_ = -1;                ///< Writable end (same as read_fd_ for eventfd).
+};
+
+/**
+ * @brief Lock-free handoff of the newest value from one writer thread to one reader thread.
+ *
+ * The writer fills write_buffer() and calls publish(), and the reader calls update() and
+ * then reads read_buffer(). Neither side ever blocks or waits for the other. Each side owns
+ * one buffer and the third is exchanged atomically, so the reader always sees the newest
+ * completely written value and intermediate values may be skipped.
+ * @tparam T The value type.
+ */
+template <typename T> class TripleBuffer {
+  public:
+    /**
+     * @brief Calls a function on all three buffers, e.g. to give them an initial value.
+     *
+     * Not thread-safe, must only be called before the writer and reader start.
+     * @param func Function called with a reference to each buffer.
+     */
+    template <typename F> void initialize(F&& func) {
+        for (T& buffer : buffers_) {
+            func(buffer);
+        }
+    }
+
+    /**
+     * @brief Gets the buffer owned by the writer. Only call from the writer thread.
+     * @return The buffer to write the next value into. It holds an older value.
+     */
+    T& write_buffer() { return buffers_[back_]; }
+
+    /**
+     * @brief Makes the value in write_buffer() available to the reader. Only call from the writer thread.
+     */
+    void publish() { back_ = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel) & INDEX; }
+
+    /**
+     * @brief Takes the newest published value, if there is one. Only call from the reader thread.
+     * @return True if read_buffer() now holds a value published since the last update().
+     */
+    bool update() {
+        if (!(middle_.load(std::memory_order_relaxed) & FRESH)) {
+            return false;
+        }
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    /**
+     * @brief Gets the buffer owned by the reader. Only call from the reader thread.
+     * @return The value taken by the last successful update().
+     */
+    const T& read_buffer() const { return buffers_[front_]; }
+
+  private:
+    static constexpr uint8_t INDEX = 0x3; ///< Mask for the buffer index in middle_.
+    static constexpr uint8_t FRESH = 0x4; ///< Set in middle_ when it holds an unread value.
+
+    T buffers_[3];
+    uint8_t back_ = 0;                 ///< Index of the writer's buffer.
+    std::atomic<uint8_t> middle_{1};   ///< Index of the exchanged buffer, plus FRESH.
+    uint8_t front_ = 2;                ///< Index of the reader's buffer.
+};
+
+struct PVHandler;
+
+/**
+ * @brief Function called with every monitor update a PVHandler decodes.
+ *
+ * Called on the PVA callback thread with the handler and the full PVStructure of the
+ * update, which is only valid during the call.
+ */
+using UpdateListener = std::function<void(const PVHandler&, const epics::pvData::PVStructure&)>;
+
+/**
+ * @brief Lock-free multi-producer/single-consumer queue of PVHandlers with new data.
+ *
+ * PVA callback threads push a handler when it receives new data, and the consuming
+ * thread (the one calling PVGroup::sync()) drains the queue, so syncing only visits
+ * handlers which actually changed. Handlers are linked intrusively so pushing never
+ * allocates, and a handler is queued at most once until it is drained.
+ */
+class UpdateQueue {
+  public:
+    /**
+     * @brief Adds a handler to the queue if it is not already queued. Safe to call from any thread.
+     * @param pv The handler which received new data.
+     */
+    void push(PVHandler* pv);
+
+    /**
+     * @brief Removes all queued handlers and calls a function on each one.
+     *
+     * Only one thread may drain the queue. A handler is marked as not queued before
+     * the function is called, so data arriving meanwhile queues it again.
+     * @param func Function called with a reference to each queued PVHandler.
+     */
+    template <typename F> void drain(F&& func);
+
+  private:
+    std::atomic<PVHandler*> head_{nullptr}; ///< Most recently pushed handler.
+};
 
 /**
  * @brief Monitors a pvac::ClientChannel's connection status.
@@ -38,8 +369,9 @@ class ConnectionMonitor : public pvac::ClientChannel::ConnectCallback {
   public:
     /**
      * @brief Constructs a ConnectionMonitor.
+     * @param notifier Optional notifier signaled when the connection status changes.
      */
-    ConnectionMonitor() = default;
+    ConnectionMonitor(std::shared_ptr<UpdateNotifier> notifier = nullptr) : notifier_(std::move(notifier)) {}
 
     /**
      * @brief Destroys the ConnectionMonitor.
@@ -59,7 +391,242 @@ class ConnectionMonitor : public pvac::ClientChannel::ConnectCallback {
     bool connected() const;
 
   private:
-    std::atomic<bool> connected_{false}; ///< Connection status flag.
+    std::atomic<bool> connected_{false};     ///< Connection status flag.
+    std::shared_ptr<UpdateNotifier> notifier_; ///< Signaled on connection changes.
+};
+
+class SharedChannel;
+
+/**
+ * @brief Progress of the channel connections made through ConnectScheduler.
+ */
+struct ConnectStats {
+    size_t channels = 0;          ///< Live shared channels.
+    size_t queued = 0;            ///< Channels waiting to be opened.
+    size_t connecting = 0;        ///< Channels opened which are still counted against the limit.
+    size_t peak_connecting = 0;   ///< Most channels ever counted against the limit at once.
+    size_t timed_out = 0;         ///< Channels which searched for CONNECT_TIMEOUT and never connected.
+    size_t connected = 0;         ///< Channels which have connected at least once.
+    double all_connected_ms = -1; ///< Time from the first new channel until all had connected, -1 while waiting.
+};
+
+/**
+ * @brief Limits how many channels are connecting at the same time.
+ *
+ * Creating a channel starts a name search, so opening hundreds of channels at once sends
+ * bursts of search requests that gateways may throttle. With a limit, new channels are
+ * queued and opened in order on a background thread, at most limit() at a time. A channel
+ * stops counting against the limit once it connects or has been searching for
+ * CONNECT_TIMEOUT. Channels which are drawn while still queued, see
+ * SharedChannel::prioritize(), are opened before the rest. The scheduler is process-wide.
+ */
+class ConnectScheduler {
+  public:
+    static constexpr double CONNECT_TIMEOUT = 1.0; ///< Seconds a connecting channel counts against the limit.
+
+    /**
+     * @brief Sets the maximum number of channels connecting at the same time.
+     *
+     * Only affects channels created afterwards.
+     * @param max_connecting The limit. Zero, the default, opens every channel right away.
+     */
+    static void set_limit(size_t max_connecting);
+
+    /**
+     * @brief Gets the maximum number of channels connecting at the same time.
+     * @return The limit, zero if unlimited.
+     */
+    static size_t limit();
+
+    /**
+     * @brief Gets the progress of the channel connections.
+     * @return A snapshot of the ConnectStats.
+     */
+    static ConnectStats stats();
+
+    /**
+     * @brief Sets a function called with the name of each channel the scheduler opens, in order.
+     *
+     * Meant for tests. Called on the scheduler's thread, after the channel is opened.
+     * @param hook The function, or nullptr to remove it.
+     */
+    static void set_open_hook(std::function<void(const std::string&)> hook);
+
+  private:
+    friend class SharedChannel;
+
+    /**
+     * @brief Opens a channel right away, or queues it if there is a limit.
+     * @param channel The channel to open.
+     */
+    static void request(const std::shared_ptr<SharedChannel>& channel);
+
+    /**
+     * @brief Moves a queued channel to the front of the queue.
+     * @param channel The channel to open next.
+     */
+    static void prioritize(const std::shared_ptr<SharedChannel>& channel);
+
+    /**
+     * @brief Called when a channel connects for the first time.
+     */
+    static void connected();
+
+    /**
+     * @brief Called when a channel is destroyed.
+     * @param was_connected True if the channel had connected.
+     */
+    static void released(bool was_connected);
+};
+
+/**
+ * @brief A channel and monitor subscription shared by every PVHandler of the same PV.
+ *
+ * Channels are kept in a process-wide registry keyed by provider and PV name, so any
+ * number of PVGroups can monitor the same PV over a single subscription. Each monitor
+ * update is forwarded to all subscribed handlers, which decode it into their own
+ * variables. The newest value is kept so handlers which subscribe later start with it.
+ * The subscription is closed when the last handler releases it.
+ */
+class SharedChannel : public pvac::ClientChannel::MonitorCallback,
+                      public pvac::ClientChannel::ConnectCallback,
+                      public std::enable_shared_from_this<SharedChannel> {
+  public:
+    /**
+     * @brief Gets the shared channel for a PV, connecting it if it isn't open yet.
+     * @param provider PVA client provider. Handlers must use the same provider object to share.
+     * @param pv_name Name of the process variable.
+     * @return A shared_ptr which keeps the subscription open while held.
+     */
+    static std::shared_ptr<SharedChannel> acquire(pvac::ClientProvider& provider, const std::string& pv_name);
+
+    /**
+     * @brief Cancels the monitor and removes this channel from the registry.
+     */
+    ~SharedChannel();
+
+    SharedChannel(const SharedChannel&) = delete;
+    SharedChannel& operator=(const SharedChannel&) = delete;
+
+    /**
+     * @brief Starts forwarding updates and connection changes to a handler.
+     *
+     * The handler immediately receives the current connection status and newest value.
+     * @param pv The handler to subscribe.
+     */
+    void subscribe(PVHandler* pv);
+
+    /**
+     * @brief Stops forwarding to a handler. No callbacks reach it after this returns.
+     * @param pv The handler to unsubscribe.
+     */
+    void unsubscribe(PVHandler* pv);
+
+    /**
+     * @brief Stops or restarts forwarding updates to a handler.
+     *
+     * The monitor is cancelled while every subscriber is paused, so the server stops
+     * sending updates, but the channel stays connected. A resumed handler immediately
+     * receives the newest value, and the monitor's first update if it was restarted.
+     * @param pv The handler to pause or resume.
+     * @param paused True to pause, false to resume.
+     */
+    void set_paused(PVHandler* pv, bool paused);
+
+    /**
+     * @brief Calls a function with the newest value while no update is forwarded.
+     *
+     * Lets a handler seed a newly added variable or listener with the current value,
+     * knowing that every later update reaches it exactly once.
+     * @param func Called with the newest value, or nullptr if none has been received.
+     */
+    void with_latest(const std::function<void(const epics::pvData::PVStructure*)>& func);
+
+    /**
+     * @brief Gets the number of live shared channels in the process.
+     * @return The number of open subscriptions.
+     */
+    static size_t count();
+
+    /**
+     * @brief Gets the underlying PVA client channel.
+     * @return A copy of the pvac::ClientChannel, empty until the channel is opened.
+     */
+    pvac::ClientChannel channel();
+
+    /**
+     * @brief Gets the name of the process variable.
+     * @return The PV name.
+     */
+    const std::string& name() const { return key_.second.str(); }
+
+    /**
+     * @brief Gets the underlying PVA monitor instance.
+     * @return A reference to the pvac::Monitor object, empty until the channel is opened.
+     */
+    pvac::Monitor& monitor() { return monitor_; }
+
+    /**
+     * @brief Checks if the channel has been opened, see ConnectScheduler.
+     * @return True once the channel has been created and its monitor started.
+     */
+    bool opened() const { return opened_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Asks the ConnectScheduler to open this channel before others still queued.
+     *
+     * Cheap once the channel is opened, so it can be called whenever the PV is drawn.
+     */
+    void prioritize();
+
+    /**
+     * @brief Creates the channel and starts the monitor.
+     *
+     * Called by the ConnectScheduler. Does nothing if the channel was already opened.
+     */
+    void open();
+
+    /**
+     * @brief Checks if the channel has ever connected.
+     * @return True once the first connection event arrived.
+     */
+    bool connected_once();
+
+  private:
+    using Key = std::pair<const pvac::ClientProvider*, InternedString>;
+
+    SharedChannel(pvac::ClientProvider& provider, const std::string& pv_name);
+
+    /**
+     * @brief Polls the monitor and forwards the updates to the subscribers. Requires mutex_.
+     */
+    void drain_monitor();
+
+    /**
+     * @brief Starts or cancels the monitor depending on whether any subscriber is unpaused.
+     * Requires monitor_mutex_.
+     */
+    void update_monitor();
+
+    void monitorEvent(const pvac::MonitorEvent& evt) override final;
+    void connectEvent(const pvac::ConnectEvent& event) override final;
+
+    Key key_;                                    ///< Registry key.
+    pvac::ClientProvider provider_;              ///< Provider the channel is opened with.
+    pvac::ClientChannel channel_;                ///< PVA client channel.
+    pvac::Monitor monitor_;                      ///< PVA data monitor.
+    std::atomic<bool> open_started_{false};      ///< Set by the first open().
+    std::atomic<bool> opened_{false};            ///< See opened().
+    std::atomic<bool> prioritized_{false};       ///< True once prioritize() queued this channel.
+    std::mutex monitor_mutex_;                   ///< Serializes starting and cancelling the monitor.
+    std::mutex mutex_;                           ///< Serializes callbacks and subscriber changes.
+    bool monitor_started_ = false;               ///< True while monitor_ is assigned.
+    size_t paused_count_ = 0;                    ///< Subscribers which are paused.
+    bool data_waiting_ = false;                  ///< Data arrived before monitor_ was assigned.
+    bool ever_connected_ = false;                ///< True once the channel has connected.
+    std::vector<PVHandler*> subscribers_;        ///< Handlers receiving updates.
+    epics::pvData::PVStructurePtr latest_;       ///< Newest value for late subscribers, null while disconnected.
+    pvac::ConnectEvent connect_event_{};         ///< Most recent connection event.
 };
 
 /**
@@ -67,17 +634,28 @@ class ConnectionMonitor : public pvac::ClientChannel::ConnectCallback {
  *
  * Handles connection, monitoring, and value updates for a PV.
  */
-struct PVHandler : public pvac::ClientChannel::MonitorCallback {
+struct PVHandler {
   public:
-    pvac::ClientChannel channel; ///< PVA client channel.
-    std::string name;            ///< Name of the process variable.
+    InternedString name; ///< Name of the process variable.
 
     /**
-     * @brief Constructs a PVHandler.
+     * @brief Constructs a PVHandler and subscribes it to the PV's SharedChannel.
      * @param provider PVA client provider.
      * @param pv_name Name of the process variable.
+     * @param notifier Optional notifier signaled when new data or connection changes arrive.
+     * @param update_queue Optional queue this handler is pushed onto when new data arrives.
      */
-    PVHandler(pvac::ClientProvider& provider, const std::string& pv_name);
+    PVHandler(pvac::ClientProvider& provider, const std::string& pv_name,
+              std::shared_ptr<UpdateNotifier> notifier = nullptr,
+              std::shared_ptr<UpdateQueue> update_queue = nullptr);
+
+    /**
+     * @brief Destroys the PVHandler and releases its rate limit timer, if any.
+     */
+    ~PVHandler();
+
+    PVHandler(const PVHandler&) = delete;
+    PVHandler& operator=(const PVHandler&) = delete;
 
     /**
      * @brief Checks if the PV channel is connected.
@@ -85,39 +663,179 @@ struct PVHandler : public pvac::ClientChannel::MonitorCallback {
      */
     bool connected() const;
 
+    /**
+     * @brief Gets the PVA client channel, which is shared with other handlers of the PV.
+     * @return A copy of the pvac::ClientChannel, empty until the ConnectScheduler opens it.
+     */
+    pvac::ClientChannel channel() const { return shared_channel_->channel(); }
+
+    /**
+     * @brief Asks for this PV's channel to be opened before other queued channels.
+     *
+     * Widgets call this when they are drawn before their PV has connected.
+     */
+    void prioritize() { shared_channel_->prioritize(); }
+
+    /**
+     * @brief Registers a viewer of this PV, e.g. a widget, for pause() and resume().
+     */
+    void add_viewer();
+
+    /**
+     * @brief Unregisters a viewer added with add_viewer().
+     */
+    void remove_viewer();
+
+    /**
+     * @brief Marks one viewer of the PV as hidden.
+     *
+     * Updates are paused once pause() has been called for every viewer, or at all if there
+     * are none. While paused, the monitored variables keep their last value and the channel
+     * stays connected. If no other handler of the PV is active, the monitor is cancelled.
+     */
+    void pause();
+
+    /**
+     * @brief Undoes one pause(). The newest value is delivered right away when updates resume.
+     */
+    void resume();
+
+    /**
+     * @brief Checks if updates are paused, see pause().
+     * @return True if paused.
+     */
+    bool paused() const;
+
     /**
      * @brief Safely copies the internal monitored value to the user variable.
-     * @return True if new data is available, false otherwise.
+     * @return True if a new value was copied or the connection or put status changed.
      */
     bool sync();
 
+    /**
+     * @brief Gets a counter which is incremented by every sync() that found new data.
+     *
+     * Connection changes and completed puts also count as new data, so anything drawn
+     * from this PV only needs to be rebuilt when the generation changes.
+     * @return The current generation.
+     */
+    uint64_t generation() const { return generation_.load(std::memory_order_relaxed); }
+
     /**
      * @brief Registers a variable to be updated when the PV monitor receives new data and sync() is called.
+     *
+     * Variables of different types may be registered for the same PV. Each update is decoded
+     * once per registered type, and only for the types which have been registered.
      * @tparam T The type of the variable to monitor.
      * @param var A reference to the variable that will be updated.
      */
     template <typename T> void set_monitor(T& var) {
-        if (std::holds_alternative<std::monostate>(monitor_var_internal_)) {
-            monitor_var_internal_ = T{};
-        }
-
-        if (!std::holds_alternative<T>(monitor_var_internal_)) {
-            throw std::runtime_error("Cannot set multiple monitors of different types for a single PV: " +
-                                     name);
-        }
+        static_assert(is_monitor_type_v<T>, "set_monitor() supports the types of MonitorVar");
+        this->add_monitor<T>(&var, nullptr);
+    }
 
-        sync_tasks_.push_back([&var](const MonitorVar& latest_data) {
-            if (auto* val = std::get_if<T>(&latest_data)) {
-                var = *val;
-            }
-        });
+    /**
+     * @brief Registers a variable to be updated with the value, alarm, and timestamp of the PV.
+     *
+     * All three are taken from the same update and copied together by sync().
+     * @tparam T The type of the value to monitor.
+     * @param var A reference to the variable that will be updated.
+     */
+    template <typename T> void set_monitor(Monitored<T>& var) {
+        static_assert(is_monitor_type_v<T>, "set_monitor() supports the types of MonitorVar");
+        this->add_monitor<T>(nullptr, &var);
     }
 
+    /**
+     * @brief Only decode the newest of the queued monitor updates and limit the decode rate.
+     *
+     * By default every monitor update is decoded. Once this is called, updates which are
+     * superseded by a newer queued update are skipped. If hz is positive, updates are also
+     * decoded at most hz times per second; the newest skipped update is decoded when the
+     * interval expires, so the last value is never lost.
+     * @param hz Maximum decode rate in Hz. Zero only coalesces queued updates.
+     */
+    void set_max_rate(double hz);
+
+    /**
+     * @brief Decodes monitor updates on a DecodePool instead of the PVA callback thread.
+     *
+     * The callback then only merges the update into a copy of the newest value, which
+     * shares the array data rather than copying it, and queues one decode on the pool.
+     * Updates arriving before the pool gets to it are coalesced as with set_max_rate(),
+     * whose rate limit still applies. Update listeners are still called with every update
+     * on the callback thread.
+     * @param pool The pool, or nullptr to decode on the callback thread again.
+     */
+    void set_decode_pool(std::shared_ptr<DecodePool> pool);
+
+    /**
+     * @brief Registers a function called with every update this handler receives.
+     *
+     * Unlike variables registered with set_monitor(), which only see the newest value at
+     * each sync(), a listener sees every update, including those coalesced before they are
+     * decoded, unless set_max_rate() with a positive rate skips them. The newest value, if
+     * any, is passed to the listener right away.
+     * @param listener The function to call, on the PVA callback thread, or on the thread
+     * decoding rate-limited updates.
+     * @return An id for remove_update_listener().
+     */
+    size_t add_update_listener(UpdateListener listener);
+
+    /**
+     * @brief Removes a listener. It is not called again after this returns.
+     * @param id The id returned by add_update_listener().
+     */
+    void remove_update_listener(size_t id);
+
+    /**
+     * @brief Writes a value to a field of the PV without blocking.
+     *
+     * The put is sent asynchronously and its result is reported by put_status(). Only one
+     * put per PV is in flight at a time; if another put is made meanwhile it is sent when
+     * the first completes, replacing any put still waiting, so only the newest value is sent.
+     * If the first is cancelled or can't be started, the waiting put is dropped rather than
+     * sent after a later one.
+     * Completion wakes up the group like new data, so widgets are redrawn.
+     * @param field The field to write, e.g. "value" or "value.index".
+     * @param value The value to write. It is converted to the field's type by the server.
+     */
+    void put(const std::string& field, PutValue value);
+
+    /**
+     * @brief Gets the status of the puts made with put().
+     * @return A copy of the current PutStatus.
+     */
+    PutStatus put_status() const;
+
+    /**
+     * @brief Gets the display and control metadata from the most recent update which changed it.
+     * @return A copy of the cached PVMetadata.
+     */
+    PVMetadata metadata() const;
+
+    /**
+     * @brief Gets counters of received, decoded, coalesced, and dropped monitor updates.
+     * @return A snapshot of the UpdateCounters for this PV.
+     */
+    UpdateCounters counters() const;
+
+    /**
+     * @brief Processes a monitor update as if it had been received on the channel.
+     *
+     * Mainly useful for testing and benchmarking the decode path without a server. With a
+     * decode pool the update may not be decoded yet when this returns, see
+     * DecodePool::wait_idle().
+     * @param root The full PVStructure of the update.
+     * @param changed The fields which changed in this update.
+     */
+    void process_update(const epics::pvData::PVStructure& root, const epics::pvData::BitSet& changed);
+
     /**
      * @brief Gets the underlying PVA monitor instance.
      * @return A reference to the pvac::Monitor object.
      */
-    pvac::Monitor& get_monitor() { return monitor_; }
+    pvac::Monitor& get_monitor() { return shared_channel_->monitor(); }
 
     /**
      * @brief Gets a shared_ptr to the ConnectionMonitor
@@ -126,33 +844,245 @@ struct PVHandler : public pvac::ClientChannel::MonitorCallback {
     std::shared_ptr<ConnectionMonitor> get_connection_monitor() const { return connection_monitor_; }
 
   private:
-    std::mutex mutex_;
-    pvac::Monitor monitor_;                                 ///< PVA data monitor.
-    MonitorVar monitor_var_internal_;                       ///< Internal variable updated by monitor
+    friend class UpdateQueue;
+    friend class SharedChannel;
+
+    std::mutex mutex_;                                      ///< Protects the slots' registered variables.
+    std::shared_ptr<UpdateNotifier> notifier_;              ///< Signaled when new data arrives.
+    std::shared_ptr<UpdateQueue> update_queue_;             ///< Queue to push this handler onto on new data.
+    std::atomic<bool> queued_{false};                       ///< True while in update_queue_.
+    PVHandler* next_queued_ = nullptr;                      ///< Intrusive link for update_queue_.
+    std::shared_ptr<SharedChannel> shared_channel_;         ///< Channel and monitor shared with other groups.
+    bool channel_paused_ = false;                           ///< Paused in shared_channel_, guarded by its mutex.
+    mutable std::mutex view_mutex_;                         ///< Protects the members below.
+    int viewers_ = 0;                                       ///< See add_viewer().
+    int pauses_ = 0;                                        ///< Outstanding pause() calls.
+    bool paused_ = false;                                   ///< See paused().
+
+    /**
+     * @brief Pauses or resumes the subscription when the viewer counts change. Requires view_mutex_.
+     */
+    void update_paused();
+
+    /**
+     * @brief Decoded values of one monitored type and the variables they are copied to.
+     *
+     * Implemented by TypedSlot<T> in pvgroup.cpp, so decoding and copying are compiled for
+     * each type. An update costs one virtual call per registered type, however many
+     * variables of that type are registered.
+     */
+    class SlotBase {
+      public:
+        virtual ~SlotBase() = default;
+
+        /**
+         * @brief Decodes an update into the back buffer. Only called by the decode thread.
+         * @return True if the value could be decoded.
+         */
+        virtual bool decode(const epics::pvData::PVStructure* pfield, int precision) = 0;
+
+        /**
+         * @brief Sets the alarm and timestamp of the back buffer. Only called by the decode thread.
+         */
+        virtual void set_alarm(const PVAlarm& alarm, const PVTimeStamp& timestamp) = 0;
+
+        /**
+         * @brief Publishes the back buffer to sync(). Only called by the decode thread.
+         */
+        virtual void publish() = 0;
+
+        /**
+         * @brief Copies the newest value to the registered variables if there is one. Requires mutex_.
+         * @return True if a new value was copied.
+         */
+        virtual bool sync() = 0;
+    };
+
+    template <typename T> class TypedSlot;
+
+    static_assert(std::variant_size_v<MonitorVar> <= 32, "active_types_ is a 32 bit mask");
+    std::array<std::unique_ptr<SlotBase>, std::variant_size_v<MonitorVar>> slots_; ///< Indexed by MonitorVar index.
+    std::atomic<uint32_t> active_types_{0}; ///< Bit i set once slots_[i] has been created.
+    std::atomic<uint32_t> alarm_types_{0};  ///< Bit i set if slots_[i] also needs the alarm and timestamp.
+    PVAlarm alarm_;                         ///< Decode thread scratch copy of the newest alarm.
+
+    /**
+     * @brief Registers a variable with the slot of type T, creating the slot if needed.
+     *
+     * Defined in pvgroup.cpp and instantiated for every MonitorVar alternative.
+     * @tparam T The MonitorVar alternative to decode.
+     * @param var A variable to copy the value to, or nullptr.
+     * @param monitored A variable to copy the value, alarm, and timestamp to, or nullptr.
+     */
+    template <typename T> void add_monitor(T* var, Monitored<T>* monitored);
     std::shared_ptr<ConnectionMonitor> connection_monitor_; ///< Monitors connection status.
-    std::vector<std::function<void(const MonitorVar&)>>
-        sync_tasks_; ///< Functions to copy internal value to user value
-    // bool new_data_ = false;
-    std::atomic<bool> new_data_ = false;
+    std::atomic<bool> new_data_ = false;       ///< Set when there is something for sync() to do.
+    std::atomic<bool> status_changed_ = false; ///< Set by connection changes and finished puts.
+    std::atomic<uint64_t> generation_{0};      ///< See generation().
 
     /**
-     * @brief Callback invoked when a monitor event occurs (e.g., new data).
-     * @param evt The monitor event containing the new data and status.
+     * @brief A put waiting to be sent or in flight.
      */
-    void monitorEvent(const pvac::MonitorEvent& evt) override final;
+    struct PutRequest {
+        std::string field;
+        PutValue value;
+    };
+
+    /**
+     * @brief Builds and completes the asynchronous puts of this handler.
+     */
+    struct PutSender : public pvac::ClientChannel::PutCallback {
+        PVHandler& pv;
+        explicit PutSender(PVHandler& pv) : pv(pv) {}
+        void putBuild(const epics::pvData::StructureConstPtr& build, Args& args) override;
+        void putDone(const pvac::PutEvent& evt) override;
+    };
+
+    mutable std::mutex put_mutex_;              ///< Protects the members below.
+    PutSender put_sender_{*this};               ///< Callback for put_op_.
+    pvac::Operation put_op_;                    ///< Put in flight, if any.
+    bool put_in_flight_ = false;                ///< True while put_op_ has not completed.
+    uint64_t put_seq_ = 0;                      ///< Incremented for every put sent.
+    PutRequest put_sending_;                    ///< Value of the put in flight.
+    std::chrono::steady_clock::time_point put_started_; ///< When the put in flight was sent.
+    std::optional<PutRequest> put_waiting_;     ///< Newest put made while another was in flight.
+    PutStatus put_status_;                      ///< Reported by put_status().
+
+    /**
+     * @brief Sends put_sending_. Must be called without put_mutex_ held.
+     * @param seq The put_seq_ assigned to this put.
+     */
+    void start_put(uint64_t seq);
+
+    /**
+     * @brief Marks the handler as having new data so the UI thread wakes up and redraws.
+     */
+    void signal_update();
+
+    /**
+     * @brief Like signal_update(), for a change other than a new value, e.g. a finished put.
+     */
+    void signal_status_change();
+
+    /**
+     * @brief Timer callback which decodes an update held back by the rate limit.
+     */
+    struct RateLimitTimer : public epicsTimerNotify {
+        PVHandler& pv;
+        explicit RateLimitTimer(PVHandler& pv) : pv(pv) {}
+        expireStatus expire(const epicsTime& current_time) override;
+    };
+
+    using clock = std::chrono::steady_clock;
+    // Lock order: SharedChannel::mutex_, decode_mutex_, pending_mutex_, listener_mutex_.
+    // receive() only takes decode_mutex_ when not coalescing, so a decode in progress never
+    // blocks the callback thread.
+    std::mutex decode_mutex_;                      ///< Protects the slots' write buffers and decoding_.
+    std::mutex pending_mutex_;                     ///< Protects the coalescing state below.
+    bool coalesce_ = false;                        ///< Only decode the newest queued update.
+    clock::duration min_decode_period_{0};         ///< 1/(max rate), zero if unlimited.
+    clock::time_point next_decode_;                ///< Earliest time of the next decode.
+    epicsTimerQueueActive* timer_queue_ = nullptr; ///< Shared EPICS timer queue.
+    epicsTimer* timer_ = nullptr;                  ///< Timer for updates held back by the rate limit.
+    std::unique_ptr<RateLimitTimer> timer_notify_; ///< Callback for timer_.
+    bool timer_armed_ = false;                     ///< True while timer_ is started.
+    epics::pvData::PVStructurePtr latest_;         ///< Copy of the newest update when coalescing.
+    epics::pvData::BitSet latest_changed_;         ///< Fields changed in the updates merged into latest_.
+    bool latest_pending_ = false;                  ///< True if latest_ has not been decoded.
+    bool latest_stale_ = false;                    ///< True if latest_ was swapped with decoding_.
+    bool batch_received_ = false;                  ///< True if receive() merged an update since flush().
+    std::shared_ptr<DecodePool> decode_pool_;      ///< Decodes latest_ off the callback thread if set.
+    bool decode_queued_ = false;                   ///< True while a decode is queued on decode_pool_.
+    std::condition_variable decode_idle_;          ///< Signaled when decode_queued_ is cleared.
+    epics::pvData::PVStructurePtr decoding_;       ///< Update taken from latest_ to decode. See decode_mutex_.
+    epics::pvData::BitSet decoding_changed_;       ///< Fields changed in decoding_. See decode_mutex_.
+    std::atomic<uint64_t> received_{0};            ///< See UpdateCounters::received.
+    std::atomic<uint64_t> decoded_{0};             ///< See UpdateCounters::decoded.
+    std::atomic<uint64_t> coalesced_{0};           ///< See UpdateCounters::coalesced.
+    std::atomic<uint64_t> dropped_{0};             ///< See UpdateCounters::dropped.
+    std::atomic<uint64_t> decode_ns_{0};           ///< See UpdateCounters::decode_ns.
+    mutable std::mutex metadata_mutex_;            ///< Protects metadata_.
+    PVMetadata metadata_;                          ///< Cached display and control metadata.
+    int precision_ = PVMetadata::DEFAULT_PRECISION; ///< Decode thread copy of metadata_.precision.
+    std::mutex listener_mutex_;                    ///< Protects listeners_, held while calling them.
+    std::vector<std::pair<size_t, UpdateListener>> listeners_; ///< Update listeners by id.
+    size_t next_listener_id_ = 0;                  ///< Id of the next added listener.
+
+    /**
+     * @brief Handles one monitor update from the SharedChannel.
+     *
+     * Decodes it right away, or merges it into latest_ when coalescing.
+     * @param root The full PVStructure of the update.
+     * @param changed The fields which changed in this update.
+     */
+    void receive(const epics::pvData::PVStructure& root, const epics::pvData::BitSet& changed);
+
+    /**
+     * @brief Called after a batch of receive() calls. Decodes latest_ if the rate limit allows.
+     */
+    void flush();
+
+    /**
+     * @brief Checks the rate limit, arming the timer if the next decode isn't due yet.
+     * Requires pending_mutex_.
+     * @return True if latest_ may be decoded now.
+     */
+    bool decode_due();
+
+    /**
+     * @brief Queues a decode on decode_pool_ unless one is queued already. Requires pending_mutex_.
+     */
+    void queue_decode();
+
+    /**
+     * @brief Takes latest_ into decoding_ and decodes it, if an update is pending.
+     *
+     * pending_mutex_ is only held to swap the buffers, so receive() can merge the next
+     * update into latest_ while this decodes.
+     */
+    void decode_pending();
+
+    /**
+     * @brief Decode task run on decode_pool_.
+     */
+    void run_queued_decode();
+
+    /**
+     * @brief Calls the update listeners.
+     * @param root The update.
+     */
+    void notify_listeners(const epics::pvData::PVStructure& root);
+
+    /**
+     * @brief Re-parses the cached metadata if the display or control fields changed.
+     * @param pfield A pointer to the PVStructure containing the new data.
+     * @param changed The fields which changed in this update.
+     */
+    void update_metadata(const epics::pvData::PVStructure* pfield, const epics::pvData::BitSet& changed);
 
     /**
      * @brief Extracts the PV value from the event and updates the monitored variable.
      * @param pfield A pointer to the PVStructure containing the new data.
+     * @param changed The fields which changed in this update.
+     */
+    void get_monitored_variable(const epics::pvData::PVStructure* pfield,
+                                const epics::pvData::BitSet& changed);
+
+    /**
+     * @brief Decodes an update into some of the slots and publishes them. Requires decode_mutex_.
+     * @param pfield A pointer to the PVStructure containing the new data.
+     * @param types Bit mask of the slots to decode into, a subset of active_types_.
+     * @return True if any slot was published.
      */
-    void get_monitored_variable(const epics::pvData::PVStructure* pfield);
+    bool decode_slots(const epics::pvData::PVStructure* pfield, uint32_t types);
 };
 
 /**
  * @brief Manages a collection of EPICS Process Variables (PVs).
  *
  * This class provides a centralized way to add, access, and monitor a group of
- * PVs, handling the underlying connections and data updates.
+ * PVs, handling the underlying connections and data updates. Connections are shared
+ * through SharedChannel, so a PV in several groups is only subscribed to once.
  */
 struct PVGroup {
   public:
@@ -176,6 +1106,13 @@ struct PVGroup {
      */
     void add(const std::string& pv_name);
 
+    /**
+     * @brief Decodes the updates of every PV in the group, including PVs added later, on a pool.
+     * @param pool The pool, or nullptr to decode on the PVA callback thread.
+     * @see PVHandler::set_decode_pool()
+     */
+    void set_decode_pool(std::shared_ptr<DecodePool> pool);
+
     /**
      * @brief Registers a variable to be updated by a specific PV in the group.
      * @tparam T The type of the variable to monitor.
@@ -188,6 +1125,17 @@ struct PVGroup {
         pv.set_monitor(var);
     }
 
+    /**
+     * @brief Calls a function on every PV in the group.
+     * @param func Function called with a reference to each PVHandler.
+     */
+    template <typename F> void for_each(F&& func) {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [name, pv] : pv_map) {
+            func(*pv);
+        }
+    }
+
     /**
      * @brief Retrieves a PVHandler from the group by its name.
      * @param pv_name The name of the PV to retrieve.
@@ -213,14 +1161,41 @@ struct PVGroup {
     PVHandler& operator[](const std::string& pv_name);
 
     /**
-     * @brief Checks if any PV in the group has received new data.
-     * @return True if new data is available in any monitor, false otherwise.
+     * @brief Copies new data to the monitored variables of PVs which received updates.
+     *
+     * Only PVs which received data since the last call are visited, so the cost scales
+     * with the number of changed PVs rather than the size of the group. Must always be
+     * called from the same thread.
+     * @return True if new data was available in any monitor, false otherwise.
      */
     bool sync();
 
+    /**
+     * @brief Gets the notifier signaled when any PV in the group receives new data
+     * or changes connection status.
+     * @return A reference to the group's UpdateNotifier.
+     */
+    UpdateNotifier& notifier() { return *notifier_; }
+
   private:
     std::mutex mutex_;
+    std::shared_ptr<UpdateNotifier> notifier_;                          ///< Shared with all handlers.
+    std::shared_ptr<UpdateQueue> update_queue_;                         ///< Handlers with new data.
     pvac::ClientProvider& provider_;                                    ///< PVA client provider.
-    std::unordered_map<std::string, std::shared_ptr<PVHandler>> pv_map; ///< Map of PVs by name.
+    std::shared_ptr<DecodePool> decode_pool_;                           ///< Given to every handler, may be null.
+    /// Map of PVs by name. The keys view the handlers' interned names.
+    std::unordered_map<std::string_view, std::shared_ptr<PVHandler>> pv_map;
 };
+
+template <typename F> void UpdateQueue::drain(F&& func) {
+    PVHandler* pv = head_.exchange(nullptr, std::memory_order_acquire);
+    while (pv) {
+        PVHandler* next = pv->next_queued_;
+        // acq_rel so data published before the handler's last push is visible to func
+        pv->queued_.exchange(false, std::memory_order_acq_rel);
+        func(*pv);
+        pv = next;
+    }
+}
+
 } // namespace pvtui
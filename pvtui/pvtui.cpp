@@ -1,6 +1,22 @@
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/component_options.hpp>
+#include <pvtui/decode_pool.hpp>
 #include <pvtui/pvtui.hpp>
+#include <pvtui/recorder.hpp>
+#include <pvtui/trace.hpp>
 
 namespace pvtui {
 
@@ -23,8 +39,15 @@ ftxui::Component make_button_widget(PVHandler& pv, const std::string& label, int
     op.label = label;
     op.on_click = [&pv, value]() {
         if (pv.connected()) {
-            pv.channel.put().set("value", value).exec();
+            pv.put("value", value);
+        }
+    };
+    op.transform = [&pv, ascii = op.transform](const ftxui::EntryState& state) {
+        ftxui::Element e = ascii(state);
+        if (pv.put_status().state == PutState::Failed) {
+            e |= ftxui::bgcolor(ftxui::Color::Red);
         }
+        return e;
     };
     return ftxui::Button(op);
 };
@@ -44,6 +67,8 @@ ftxui::Component make_input_widget(PVHandler& pv, std::string& disp_str, PVPutTy
             s.element |= ftxui::inverted;
         } else if (s.hovered) {
             s.element |= ftxui::bgcolor(ftxui::Color::GrayDark);
+        } else if (pv.put_status().state == PutState::Failed) {
+            s.element |= ftxui::bgcolor(ftxui::Color::Red);
         }
         return s.element;
     };
@@ -58,16 +83,16 @@ ftxui::Component make_input_widget(PVHandler& pv, std::string& disp_str, PVPutTy
             if (put_type == PVPutType::Double) {
                 try {
                     double val_double = std::stod(disp_str);
-                    pv.channel.put().set("value", val_double).exec();
+                    pv.put("value", val_double);
                 } catch (const std::exception&) {
                     // handle parse error if needed
                 }
             } else if (put_type == PVPutType::String) {
-                pv.channel.put().set("value", disp_str).exec();
+                pv.put("value", disp_str);
             } else if (put_type == PVPutType::Integer) {
                 try {
                     int val_int = std::stoi(disp_str);
-                    pv.channel.put().set("value", val_int).exec();
+                    pv.put("value", val_int);
                 } catch (const std::exception&) {
                     // handle parse error if needed
                 }
@@ -78,13 +103,13 @@ ftxui::Component make_input_widget(PVHandler& pv, std::string& disp_str, PVPutTy
     return ftxui::Input(input_op);
 }
 
-ftxui::Component make_choice_h_widget(PVHandler& pv, const std::vector<std::string>& labels, int& selected) {
+ftxui::Component make_choice_h_widget(PVHandler& pv, ftxui::ConstStringListRef labels, int& selected) {
     ftxui::MenuOption op = ftxui::MenuOption::Toggle();
-    op.entries = &labels;
+    op.entries = labels;
     op.selected = &selected;
     op.on_change = [&]() {
         if (pv.connected()) {
-            pv.channel.put().set("value.index", selected).exec();
+            pv.put("value.index", selected);
         }
     };
 
@@ -97,19 +122,22 @@ ftxui::Component make_choice_h_widget(PVHandler& pv, const std::vector<std::stri
         if (!state.focused && !state.active) {
             e |= color | ftxui::dim;
         }
+        if (state.active && pv.put_status().state == PutState::Failed) {
+            e |= ftxui::bgcolor(ftxui::Color::Red);
+        }
         return e;
     };
 
     return ftxui::Menu(op);
 }
 
-ftxui::Component make_choice_v_widget(PVHandler& pv, const std::vector<std::string>& labels, int& selected) {
+ftxui::Component make_choice_v_widget(PVHandler& pv, ftxui::ConstStringListRef labels, int& selected) {
     ftxui::MenuOption op = ftxui::MenuOption::Vertical();
-    op.entries = &labels;
+    op.entries = labels;
     op.selected = &selected;
     op.on_change = [&]() {
         if (pv.connected()) {
-            pv.channel.put().set("value.index", selected).exec();
+            pv.put("value.index", selected);
         }
     };
     op.entries_option.transform = [&pv](const ftxui::EntryState& state) {
@@ -123,25 +151,31 @@ ftxui::Component make_choice_v_widget(PVHandler& pv, const std::vector<std::stri
         if (!state.focused && !state.active) {
             e |= ftxui::dim;
         }
+        if (state.active && pv.put_status().state == PutState::Failed) {
+            e |= ftxui::bgcolor(ftxui::Color::Red);
+        }
         return e;
     };
     return ftxui::Menu(op);
 }
 
-ftxui::Component make_dropdown_widget(PVHandler& pv, const std::vector<std::string>& labels, int& selected) {
+ftxui::Component make_dropdown_widget(PVHandler& pv, ftxui::ConstStringListRef labels, int& selected) {
     using namespace ftxui;
 
     DropdownOption dropdown_op;
 
-    dropdown_op.radiobox.entries = &labels;
+    dropdown_op.radiobox.entries = labels;
     dropdown_op.radiobox.selected = &selected;
     dropdown_op.radiobox.on_change = [&]() {
         if (pv.connected()) {
-            pv.channel.put().set("value.index", selected).exec();
+            pv.put("value.index", selected);
         }
     };
 
-    dropdown_op.transform = [](bool open, ftxui::Element checkbox, ftxui::Element radiobox) {
+    dropdown_op.transform = [&pv](bool open, ftxui::Element checkbox, ftxui::Element radiobox) {
+        if (pv.put_status().state == PutState::Failed) {
+            checkbox |= bgcolor(Color::Red);
+        }
         if (open) {
             return ftxui::vbox({
                 checkbox | inverted,
@@ -160,9 +194,21 @@ ftxui::Component make_dropdown_widget(PVHandler& pv, const std::vector<std::stri
 ArgParser::ArgParser(int argc, char* argv[]) {
     cmdl_.add_params({"-m", "--macro", "--macros"});
     cmdl_.add_params({"--provider"});
+    cmdl_.add_params({"--trace"});
+    cmdl_.add_params({"--format", "--output", "--max-rate", "--max-connects", "--decoders"});
     cmdl_.parse(argc, argv);
     this->macros = get_macro_dict(cmdl_({"-m", "--macro", "--macros"}).str());
     this->provider = cmdl_("--provider").str().empty() ? "ca" : cmdl_("--provider").str();
+    this->stats = cmdl_["stats"];
+    this->trace = cmdl_("--trace").str();
+    this->headless = cmdl_["headless"];
+    if (!cmdl_("--format").str().empty()) {
+        this->format = cmdl_("--format").str();
+    }
+    this->output = cmdl_("--output").str();
+    cmdl_("--max-rate", 0.0) >> this->max_rate;
+    cmdl_("--max-connects", this->max_connects) >> this->max_connects;
+    cmdl_("--decoders", this->decoders) >> this->decoders;
 };
 
 bool ArgParser::macros_present(const std::vector<std::string>& macro_list) const {
@@ -220,48 +266,495 @@ static pvac::ClientProvider init_epics_provider(const std::string& p) {
     return provider;
 }
 
+WaitResult wait_for_events(UpdateNotifier& notifier, int timeout_ms) {
+    pollfd fds[2] = {
+        {STDIN_FILENO, POLLIN, 0},
+        {notifier.fd(), POLLIN, 0},
+    };
+    // EINTR (e.g. SIGWINCH on terminal resize) just returns so the loop can redraw
+    if (poll(fds, 2, timeout_ms) <= 0) {
+        return WaitResult::None;
+    }
+    // Checked first, since a hung up terminal also reports POLLIN for the end of file
+    if (fds[0].revents & (POLLHUP | POLLERR | POLLNVAL)) {
+        return WaitResult::Closed;
+    }
+    return fds[0].revents & POLLIN ? WaitResult::Input : WaitResult::None;
+}
+
+// Checks if the terminal is still writing out previous frames, e.g. on a slow link
+static bool terminal_backlogged() {
+#ifdef TIOCOUTQ
+    constexpr int MAX_QUEUED_BYTES = 4096;
+    int queued = 0;
+    if (ioctl(STDOUT_FILENO, TIOCOUTQ, &queued) == 0) {
+        return queued > MAX_QUEUED_BYTES;
+    }
+#endif
+    return false;
+}
+
+namespace {
+
+// Forwards to another stream buffer and counts the bytes written through it
+class CountingStreambuf : public std::streambuf {
+  public:
+    explicit CountingStreambuf(std::streambuf* dest) : dest_(dest) {}
+    uint64_t count() const { return count_; }
+
+  protected:
+    int_type overflow(int_type ch) override {
+        if (traits_type::eq_int_type(ch, traits_type::eof())) {
+            return traits_type::not_eof(ch);
+        }
+        count_++;
+        return dest_->sputc(traits_type::to_char_type(ch));
+    }
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        const std::streamsize written = dest_->sputn(s, n);
+        count_ += written;
+        return written;
+    }
+    int sync() override { return dest_->pubsync(); }
+
+  private:
+    std::streambuf* dest_;
+    uint64_t count_ = 0;
+};
+
+// Installs a CountingStreambuf on std::cout for its lifetime
+class CoutCounter {
+  public:
+    CoutCounter() : counter_(std::cout.rdbuf()), original_(std::cout.rdbuf(&counter_)) {}
+    ~CoutCounter() { std::cout.rdbuf(original_); }
+    uint64_t count() const { return counter_.count(); }
+
+  private:
+    CountingStreambuf counter_;
+    std::streambuf* original_;
+};
+
+// Live counters drawn over the application when App::show_stats is set
+class StatsOverlay {
+  public:
+    static constexpr size_t NUM_TOP_PVS = 5;
+
+    explicit StatsOverlay(App& app) : app_(app), last_sample_(clock::now()) {}
+
+    // Samples the counters if a second has passed. Returns true if the numbers changed.
+    bool sample() {
+        const auto now = clock::now();
+        const double dt = std::chrono::duration<double>(now - last_sample_).count();
+        if (dt < 1.0) {
+            return false;
+        }
+        last_sample_ = now;
+
+        uint64_t updates = 0;
+        uint64_t decoded = 0;
+        uint64_t decode_ns = 0;
+        connected_ = 0;
+        total_ = 0;
+        put_ms_ = 0.0;
+        top_.clear();
+        app_.pvgroup.for_each([&](PVHandler& pv) {
+            const UpdateCounters c = pv.counters();
+            UpdateCounters& last = last_counters_[&pv];
+            updates += c.received - last.received;
+            decoded += c.decoded - last.decoded;
+            decode_ns += c.decode_ns - last.decode_ns;
+            top_.push_back({pv.name, (c.received - last.received) / dt});
+            last = c;
+
+            total_++;
+            if (pv.connected()) {
+                connected_++;
+            }
+            put_ms_ = std::max(put_ms_, pv.put_status().last_latency_ms);
+        });
+
+        const size_t n = std::min(NUM_TOP_PVS, top_.size());
+        std::partial_sort(top_.begin(), top_.begin() + n, top_.end(),
+                          [](const PVRate& a, const PVRate& b) { return a.per_sec > b.per_sec; });
+        top_.resize(n);
+
+        connect_ = ConnectScheduler::stats();
+        updates_per_sec_ = updates / dt;
+        decode_us_ = decoded ? decode_ns / 1000.0 / decoded : 0.0;
+        bytes_per_sec_ = (app_.render_stats.bytes_written - last_bytes_) / dt;
+        last_bytes_ = app_.render_stats.bytes_written;
+        return true;
+    }
+
+    ftxui::Element render() const {
+        using namespace ftxui;
+        const RenderStats& r = app_.render_stats;
+        Elements rows = {
+            row("channels", std::to_string(connected_) + "/" + std::to_string(total_) + " connected"),
+            row("connect", connect_text()),
+            row("updates", format("%.1f /s", updates_per_sec_)),
+            row("decode", format("%.2f us/update", decode_us_)),
+            row("sync", format("%.3f ms (avg %.3f)", r.last_sync_ms, r.avg_sync_ms)),
+            row("frame", format("%.2f ms (avg %.2f)", r.last_frame_ms, r.avg_frame_ms)),
+            row("frames", std::to_string(r.frames) + " drawn, " + std::to_string(r.frames_skipped) + " merged"),
+            row("output", format("%.1f kB/s", bytes_per_sec_ / 1000.0)),
+            row("put", format("%.1f ms", put_ms_)),
+            separator(),
+            text("busiest PVs") | bold,
+        };
+        for (const auto& pv : top_) {
+            rows.push_back(row(pv.name, format("%.1f /s", pv.per_sec)));
+        }
+        return window(text(" stats (F12) "), vbox(rows)) | clear_under | bgcolor(Color::Black) |
+               color(Color::White);
+    }
+
+  private:
+    using clock = std::chrono::steady_clock;
+
+    struct PVRate {
+        std::string name;
+        double per_sec;
+    };
+
+    std::string connect_text() const {
+        if (connect_.all_connected_ms >= 0.0) {
+            return format("all in %.0f ms", connect_.all_connected_ms);
+        }
+        if (connect_.queued > 0) {
+            return std::to_string(connect_.queued) + " queued";
+        }
+        // Nothing left to open, but some channels never connected
+        std::string text = std::to_string(connect_.channels - connect_.connected) + " not connected";
+        if (connect_.timed_out > 0) {
+            text += ", " + std::to_string(connect_.timed_out) + " timed out";
+        }
+        return text;
+    }
+
+    static ftxui::Element row(const std::string& label, const std::string& value) {
+        using namespace ftxui;
+        return hbox({text(label) | size(WIDTH, EQUAL, 12), text(" "), text(value)});
+    }
+
+    static std::string format(const char* fmt, double value) {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), fmt, value);
+        return buf;
+    }
+
+    static std::string format(const char* fmt, double a, double b) {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), fmt, a, b);
+        return buf;
+    }
+
+    App& app_;
+    clock::time_point last_sample_;
+    std::unordered_map<const PVHandler*, UpdateCounters> last_counters_;
+    uint64_t last_bytes_ = 0;
+    double updates_per_sec_ = 0.0;
+    double decode_us_ = 0.0;
+    double bytes_per_sec_ = 0.0;
+    double put_ms_ = 0.0;
+    size_t connected_ = 0;
+    size_t total_ = 0;
+    ConnectStats connect_;
+    std::vector<PVRate> top_;
+};
+
+} // namespace
+
 App::App(int argc, char* argv[])
     : args(argc, argv), provider(init_epics_provider(args.provider)), pvgroup(provider),
       screen(ftxui::ScreenInteractive::Fullscreen()) {
 
+    show_stats = args.stats;
+    // Before any widget creates a channel
+    ConnectScheduler::set_limit(args.max_connects);
+    if (args.decoders > 0) {
+        pvgroup.set_decode_pool(std::make_shared<DecodePool>(args.decoders));
+    }
+    if (!args.trace.empty()) {
+        trace::enable(args.trace);
+    }
+
     main_loop = [](App& app, const ftxui::Component& renderer, int ms) {
-        ftxui::Loop loop(&app.screen, renderer);
+        // After terminal input, FTXUI may be holding a partial escape sequence (e.g. a lone ESC)
+        // which it only flushes on a later RunOnce, so don't block indefinitely in that case.
+        constexpr int ESCAPE_FLUSH_MS = 50;
+
+        // Destroyed after the loop, so the terminal cleanup is still counted
+        CoutCounter cout_counter;
+        StatsOverlay overlay(app);
+
+        // Cached elements may hold the focus and cursor state of components, which input changes
+        auto root = ftxui::CatchEvent(renderer, [&app](const ftxui::Event& event) {
+            if (event == ftxui::Event::F12) {
+                app.show_stats = !app.show_stats;
+                return true;
+            }
+            if (event != ftxui::Event::Custom) {
+                ElementCache::invalidate_all();
+            }
+            return false;
+        });
+        auto with_overlay = ftxui::Renderer(root, [&app, &root, &overlay] {
+            if (!app.show_stats) {
+                return root->Render();
+            }
+            return ftxui::dbox({
+                root->Render(),
+                ftxui::hbox({ftxui::filler(), ftxui::vbox({overlay.render(), ftxui::filler()})}),
+            });
+        });
+        ftxui::Loop loop(&app.screen, with_overlay);
+        UpdateNotifier& notifier = app.pvgroup.notifier();
+
+        using clock = std::chrono::steady_clock;
+        const auto min_period =
+            app.max_fps > 0.0 ? std::chrono::duration_cast<clock::duration>(
+                                    std::chrono::duration<double>(1.0 / app.max_fps))
+                              : clock::duration::zero();
+        auto next_frame = clock::now();
+        bool dirty = true; // PV data may be waiting, or the first frame hasn't been drawn
+        bool first_frame = true;
+        bool got_input = false;
         while (!loop.HasQuitted()) {
-            if (app.pvgroup.sync()) {
+            auto now = clock::now();
+            bool draw = false;
+            if (dirty && (got_input || now >= next_frame)) {
+                if (!got_input && terminal_backlogged()) {
+                    // Let the terminal catch up before queueing another frame
+                    next_frame = now + std::max(min_period, clock::duration(std::chrono::milliseconds(10)));
+                } else {
+                    notifier.clear();
+                    dirty = false;
+                    const auto sync_start = clock::now();
+                    const bool new_data = app.pvgroup.sync();
+                    RenderStats& stats = app.render_stats;
+                    stats.last_sync_ms =
+                        std::chrono::duration<double, std::milli>(clock::now() - sync_start).count();
+                    stats.avg_sync_ms = 0.9 * stats.avg_sync_ms + 0.1 * stats.last_sync_ms;
+                    if (new_data || first_frame) {
+                        app.screen.PostEvent(ftxui::Event::Custom);
+                        first_frame = false;
+                        next_frame = now + min_period;
+                        draw = true;
+                    }
+                }
+            }
+
+            // The overlay's rates are refreshed once per second, even without new data
+            if (app.show_stats && overlay.sample()) {
                 app.screen.PostEvent(ftxui::Event::Custom);
+                draw = true;
+            }
+
+            const auto start = clock::now();
+            {
+                PVTUI_TRACE("RunOnce");
+                loop.RunOnce();
+            }
+            app.render_stats.bytes_written = cout_counter.count();
+            if (draw || got_input) {
+                const double frame_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+                RenderStats& stats = app.render_stats;
+                stats.frames++;
+                stats.last_frame_ms = frame_ms;
+                stats.avg_frame_ms = stats.frames == 1 ? frame_ms : 0.9 * stats.avg_frame_ms + 0.1 * frame_ms;
+            }
+
+            // Wait for input, new data, or the next frame slot if data is waiting
+            int timeout_ms = ms;
+            if (app.show_stats && (timeout_ms < 0 || timeout_ms > 1000)) {
+                timeout_ms = 1000;
+            }
+            if (dirty) {
+                now = clock::now();
+                const int until_frame = next_frame > now
+                    ? static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(next_frame - now).count())
+                    : 0;
+                timeout_ms = timeout_ms < 0 ? until_frame : std::min(timeout_ms, until_frame);
+            }
+            if (got_input && (timeout_ms < 0 || timeout_ms > ESCAPE_FLUSH_MS)) {
+                timeout_ms = ESCAPE_FLUSH_MS;
+            }
+            const WaitResult woke = wait_for_events(notifier, timeout_ms);
+            if (woke == WaitResult::Closed) {
+                break; // nothing can be drawn or read anymore
+            }
+            got_input = woke == WaitResult::Input;
+            if (trace::take_dump_request()) {
+                trace::dump();
+            }
+            if (notifier.pending()) {
+                // Data arriving while a frame is already waiting is merged into it
+                notifier.clear();
+                if (dirty) {
+                    app.render_stats.frames_skipped++;
+                }
+                dirty = true;
+            } else if (!got_input && ms >= 0) {
+                dirty = true; // poll period expired, check for data anyway
             }
-            loop.RunOnce();
-            std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        }
+        if (trace::enabled()) {
+            trace::dump();
         }
     };
 }
 
+namespace {
+std::atomic<bool> g_headless_stop{false};
+int g_headless_wake_fd = -1;
+
+void on_headless_signal(int) {
+    // The signal may be delivered to any thread, so poll() in run_headless is woken
+    // explicitly. write() is async-signal-safe.
+    const int saved_errno = errno;
+    g_headless_stop.store(true, std::memory_order_relaxed);
+    const uint64_t one = 1;
+    [[maybe_unused]] const ssize_t written = write(g_headless_wake_fd, &one, sizeof(one));
+    errno = saved_errno;
+}
+
+// Handles SIGINT and SIGTERM while recording, restoring the previous handlers afterwards
+class HeadlessSignals {
+  public:
+    HeadlessSignals() {
+        g_headless_stop.store(false, std::memory_order_relaxed);
+        g_headless_wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        struct sigaction action = {};
+        action.sa_handler = on_headless_signal;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, &old_int_);
+        sigaction(SIGTERM, &action, &old_term_);
+    }
+
+    ~HeadlessSignals() {
+        sigaction(SIGINT, &old_int_, nullptr);
+        sigaction(SIGTERM, &old_term_, nullptr);
+        if (g_headless_wake_fd >= 0) {
+            close(g_headless_wake_fd);
+            g_headless_wake_fd = -1;
+        }
+    }
+
+    HeadlessSignals(const HeadlessSignals&) = delete;
+    HeadlessSignals& operator=(const HeadlessSignals&) = delete;
+
+  private:
+    struct sigaction old_int_ = {};
+    struct sigaction old_term_ = {};
+};
+
+// Records every update of the app's PVs until SIGINT or SIGTERM
+void run_headless(App& app) {
+    const auto format = parse_record_format(app.args.format);
+    if (!format) {
+        throw std::runtime_error("Unknown --format " + app.args.format + ", expected csv or jsonl");
+    }
+    std::unique_ptr<UpdateRecorder> recorder =
+        app.args.output.empty() ? std::make_unique<UpdateRecorder>(std::cout, *format)
+                                : std::make_unique<UpdateRecorder>(app.args.output, *format);
+
+    if (app.args.max_rate > 0.0) {
+        app.pvgroup.for_each([&app](PVHandler& pv) { pv.set_max_rate(app.args.max_rate); });
+    }
+    recorder->attach(app.pvgroup);
+
+    const HeadlessSignals signals;
+
+    // Updates are written from the callback threads when the buffer fills, so this
+    // thread sleeps until the rest is due to be pushed out or a signal arrives
+    constexpr auto FLUSH_PERIOD = std::chrono::milliseconds(500);
+    auto next_flush = std::chrono::steady_clock::now() + FLUSH_PERIOD;
+    while (!g_headless_stop.load(std::memory_order_relaxed)) {
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= next_flush) {
+            recorder->flush();
+            next_flush += FLUSH_PERIOD;
+            continue;
+        }
+        pollfd fd = {g_headless_wake_fd, POLLIN, 0};
+        poll(&fd, 1, static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(next_flush - now).count()));
+        if (trace::take_dump_request()) {
+            trace::dump();
+        }
+    }
+    recorder.reset();
+    if (trace::enabled()) {
+        trace::dump();
+    }
+}
+} // namespace
+
 void App::run(const ftxui::Component& renderer, int poll_period_ms) {
+    if (args.headless) {
+        run_headless(*this);
+        return;
+    }
     main_loop(*this, renderer, poll_period_ms);
 }
 
 WidgetBase::WidgetBase(PVGroup& pvgroup, const ArgParser& args, const std::string& pv_name)
     : pvgroup_(pvgroup), pv_name_(args.replace(pv_name)) {
     pvgroup.add(pv_name_);
-    connection_monitor_ = pvgroup[pv_name_].get_connection_monitor();
-    pvgroup[pv_name_].channel.addConnectListener(connection_monitor_.get());
+    handler_ = pvgroup.get_pv_shared(pv_name_);
+    connection_monitor_ = handler_->get_connection_monitor();
+    view_ = std::make_shared<View>(handler_);
 };
 
 WidgetBase::WidgetBase(PVGroup& pvgroup, const std::string& pv_name) : pvgroup_(pvgroup), pv_name_(pv_name) {
     pvgroup.add(pv_name_);
-    connection_monitor_ = pvgroup[pv_name_].get_connection_monitor();
-    pvgroup[pv_name_].channel.addConnectListener(connection_monitor_.get());
+    handler_ = pvgroup.get_pv_shared(pv_name_);
+    connection_monitor_ = handler_->get_connection_monitor();
+    view_ = std::make_shared<View>(handler_);
 };
 
-std::string WidgetBase::pv_name() const { return pv_name_; }
+WidgetBase::View::View(std::shared_ptr<PVHandler> pv) : pv(std::move(pv)) { this->pv->add_viewer(); }
+
+WidgetBase::View::~View() {
+    // Removing the viewer first keeps the PV paused while its other widgets are hidden
+    pv->remove_viewer();
+    if (!visible) {
+        pv->resume();
+    }
+}
+
+void WidgetBase::set_visible(bool visible) {
+    if (visible == view_->visible) {
+        return;
+    }
+    view_->visible = visible;
+    if (visible) {
+        handler_->resume();
+    } else {
+        handler_->pause();
+    }
+}
+
+bool WidgetBase::visible() const { return view_->visible; }
+
+const std::string& WidgetBase::pv_name() const { return pv_name_; }
 
-bool WidgetBase::connected() const { return connection_monitor_->connected(); }
+bool WidgetBase::connected() const {
+    if (connection_monitor_->connected()) {
+        return true;
+    }
+    // Called while drawing, so channels on screen are opened before the rest
+    handler_->prioritize();
+    return false;
+}
+
+uint64_t WidgetBase::generation() const { return handler_->generation(); }
 
 ftxui::Component WidgetBase::component() const {
     if (component_) {
         return component_;
     } else {
-        throw std::runtime_error("No component defined for " + pv_name_);
+        throw std::runtime_error("No component defined for " + pv_name_.str());
     }
 }
 
@@ -286,51 +779,63 @@ InputWidget::InputWidget(PVGroup& pvgroup, const std::string& pv_name, PVPutType
 
 const std::string& InputWidget::value() const { return *value_ptr_; }
 
+// Reads the current shared choice list, so FTXUI sees the choices replaced by sync()
+struct ChoiceWidget::Labels : public ftxui::ConstStringListRef::Adapter {
+    explicit Labels(std::shared_ptr<PVEnum> value) : value(std::move(value)) {}
+    size_t size() const override { return value->choices->size(); }
+    std::string operator[](size_t i) const override { return (*value->choices)[i]; }
+
+    std::shared_ptr<PVEnum> value;
+};
+
 ChoiceWidget::ChoiceWidget(PVGroup& pvgroup, const ArgParser& args, const std::string& pv_name,
                            ChoiceStyle style)
-    : WidgetBase(pvgroup, args, pv_name), value_ptr_(std::make_shared<PVEnum>()) {
+    : WidgetBase(pvgroup, args, pv_name), value_ptr_(std::make_shared<PVEnum>()),
+      labels_(std::make_shared<Labels>(value_ptr_)) {
     pvgroup.set_monitor(pv_name_, *value_ptr_);
     switch (style) {
     case pvtui::ChoiceStyle::Vertical:
-        component_ = make_choice_v_widget(pvgroup.get_pv(pv_name_), value_ptr_->choices, value_ptr_->index);
+        component_ = make_choice_v_widget(pvgroup.get_pv(pv_name_), labels_.get(), value_ptr_->index);
         break;
     case pvtui::ChoiceStyle::Horizontal:
-        component_ = make_choice_h_widget(pvgroup.get_pv(pv_name_), value_ptr_->choices, value_ptr_->index);
+        component_ = make_choice_h_widget(pvgroup.get_pv(pv_name_), labels_.get(), value_ptr_->index);
         break;
     case pvtui::ChoiceStyle::Dropdown:
-        component_ = make_dropdown_widget(pvgroup.get_pv(pv_name_), value_ptr_->choices, value_ptr_->index);
+        component_ = make_dropdown_widget(pvgroup.get_pv(pv_name_), labels_.get(), value_ptr_->index);
         break;
     }
 }
 
 ChoiceWidget::ChoiceWidget(App& app, const std::string& pv_name, ChoiceStyle style)
-    : WidgetBase(app.pvgroup, app.args, pv_name), value_ptr_(std::make_shared<PVEnum>()) {
+    : WidgetBase(app.pvgroup, app.args, pv_name), value_ptr_(std::make_shared<PVEnum>()),
+      labels_(std::make_shared<Labels>(value_ptr_)) {
     app.pvgroup.set_monitor(pv_name_, *value_ptr_);
     switch (style) {
     case pvtui::ChoiceStyle::Vertical:
-        component_ = make_choice_v_widget(app.pvgroup.get_pv(pv_name_), value_ptr_->choices, value_ptr_->index);
+        component_ = make_choice_v_widget(app.pvgroup.get_pv(pv_name_), labels_.get(), value_ptr_->index);
         break;
     case pvtui::ChoiceStyle::Horizontal:
-        component_ = make_choice_h_widget(app.pvgroup.get_pv(pv_name_), value_ptr_->choices, value_ptr_->index);
+        component_ = make_choice_h_widget(app.pvgroup.get_pv(pv_name_), labels_.get(), value_ptr_->index);
         break;
     case pvtui::ChoiceStyle::Dropdown:
-        component_ = make_dropdown_widget(app.pvgroup.get_pv(pv_name_), value_ptr_->choices, value_ptr_->index);
+        component_ = make_dropdown_widget(app.pvgroup.get_pv(pv_name_), labels_.get(), value_ptr_->index);
         break;
     }
 }
 
 ChoiceWidget::ChoiceWidget(PVGroup& pvgroup, const std::string& pv_name, ChoiceStyle style)
-    : WidgetBase(pvgroup, pv_name), value_ptr_(std::make_shared<PVEnum>()) {
+    : WidgetBase(pvgroup, pv_name), value_ptr_(std::make_shared<PVEnum>()),
+      labels_(std::make_shared<Labels>(value_ptr_)) {
     pvgroup.set_monitor(pv_name_, *value_ptr_);
     switch (style) {
     case pvtui::ChoiceStyle::Vertical:
-        component_ = make_choice_v_widget(pvgroup.get_pv(pv_name_), value_ptr_->choices, value_ptr_->index);
+        component_ = make_choice_v_widget(pvgroup.get_pv(pv_name_), labels_.get(), value_ptr_->index);
         break;
     case pvtui::ChoiceStyle::Horizontal:
-        component_ = make_choice_h_widget(pvgroup.get_pv(pv_name_), value_ptr_->choices, value_ptr_->index);
+        component_ = make_choice_h_widget(pvgroup.get_pv(pv_name_), labels_.get(), value_ptr_->index);
         break;
     case pvtui::ChoiceStyle::Dropdown:
-        component_ = make_dropdown_widget(pvgroup.get_pv(pv_name_), value_ptr_->choices, value_ptr_->index);
+        component_ = make_dropdown_widget(pvgroup.get_pv(pv_name_), labels_.get(), value_ptr_->index);
         break;
     }
 }
@@ -354,4 +859,284 @@ ButtonWidget::ButtonWidget(PVGroup& pvgroup, const std::string& pv_name, const s
     component_ = make_button_widget(pvgroup.get_pv(pv_name_), label, press_val);
 }
 
+namespace {
+// Fits [lo, hi] to the non-empty columns of the envelopes, false if there are none
+bool fit_range(const std::vector<const WaveformEnvelope*>& envelopes, double& lo, double& hi) {
+    lo = std::numeric_limits<double>::infinity();
+    hi = -lo;
+    for (const WaveformEnvelope* env : envelopes) {
+        for (size_t x = 0; x < env->size(); x++) {
+            if (env->min[x] <= env->max[x]) {
+                lo = std::min(lo, env->min[x]);
+                hi = std::max(hi, env->max[x]);
+            }
+        }
+    }
+    if (!(lo <= hi) || !std::isfinite(hi - lo)) {
+        return false;
+    }
+    if (lo == hi) {
+        lo -= 1.0;
+        hi += 1.0;
+    }
+    return true;
+}
+
+// One vertical line per column, extended to meet the previous column so the trace is connected
+void draw_envelope(ftxui::Canvas& canvas, const WaveformEnvelope& env, double lo, double hi,
+                   const ftxui::Color& color) {
+    const int bottom = canvas.height() - 1;
+    const double scale = bottom / (hi - lo);
+    auto to_y = [&](double v) { return std::clamp(static_cast<int>(std::lround((hi - v) * scale)), 0, bottom); };
+
+    bool have_prev = false;
+    double prev_min = 0.0;
+    double prev_max = 0.0;
+    for (size_t x = 0; x < env.size(); x++) {
+        const double mn = env.min[x];
+        const double mx = env.max[x];
+        if (!(mn <= mx)) {
+            have_prev = false;
+            continue;
+        }
+        double from = mn;
+        double to = mx;
+        if (have_prev) {
+            from = std::min(mn, prev_max);
+            to = std::max(mx, prev_min);
+        }
+        canvas.DrawPointLine(x, to_y(from), x, to_y(to), color);
+        have_prev = true;
+        prev_min = mn;
+        prev_max = mx;
+    }
+}
+
+// A canvas of the given size in dots, or filling the available space if either is zero
+ftxui::Element make_canvas(int width, int height, std::function<void(ftxui::Canvas&)> draw) {
+    if (width > 0 && height > 0) {
+        return ftxui::canvas(width, height, std::move(draw));
+    }
+    return ftxui::canvas(std::move(draw));
+}
+} // namespace
+
+// State shared by copies of a WaveformWidget and by widgets drawing its trace
+struct WaveformWidget::Plot {
+    std::shared_ptr<PVHandler> handler;
+    ftxui::Color color;
+    SharedArray<double> value;
+    std::vector<std::shared_ptr<const Plot>> traces; // drawn on this plot's canvas
+    double low = 0.0;                                // fixed range, if low < high
+    double high = 0.0;
+
+    // Cache of get_envelope(), keyed on the handler's generation and the number of columns
+    mutable WaveformEnvelope envelope;
+    mutable uint64_t generation = 0;
+    mutable bool cached = false;
+
+    const WaveformEnvelope& get_envelope(size_t columns) const {
+        const uint64_t gen = handler->generation();
+        if (!cached || gen != generation || columns != envelope.size()) {
+            PVTUI_TRACE("WaveformWidget decimate", handler->name.c_str());
+            minmax_decimate(value.data(), value.size(), columns, envelope);
+            generation = gen;
+            cached = true;
+        }
+        return envelope;
+    }
+
+    void draw(ftxui::Canvas& canvas) const {
+        const size_t columns = canvas.width();
+        if (columns == 0 || canvas.height() <= 0) {
+            return;
+        }
+        std::vector<const Plot*> plots = {this};
+        std::vector<const WaveformEnvelope*> envelopes = {&this->get_envelope(columns)};
+        for (const auto& trace : traces) {
+            plots.push_back(trace.get());
+            envelopes.push_back(&trace->get_envelope(columns));
+        }
+
+        double lo = low;
+        double hi = high;
+        if (!(lo < hi) && !fit_range(envelopes, lo, hi)) {
+            return;
+        }
+        for (size_t i = 0; i < plots.size(); i++) {
+            draw_envelope(canvas, *envelopes[i], lo, hi, plots[i]->color);
+        }
+    }
+
+    // The element keeps the plot alive until it is drawn
+    static ftxui::Element render(const std::shared_ptr<const Plot>& plot, int width, int height) {
+        return make_canvas(width, height, [plot](ftxui::Canvas& canvas) { plot->draw(canvas); });
+    }
+};
+
+WaveformWidget::WaveformWidget(PVGroup& pvgroup, const ArgParser& args, const std::string& pv_name,
+                               ftxui::Color color)
+    : WidgetBase(pvgroup, args, pv_name), plot_(std::make_shared<Plot>()) {
+    plot_->handler = handler_;
+    plot_->color = color;
+    pvgroup.set_monitor(pv_name_, plot_->value);
+    component_ = ftxui::Renderer([plot = plot_] { return Plot::render(plot, 0, 0); });
+}
+
+WaveformWidget::WaveformWidget(PVGroup& pvgroup, const std::string& pv_name, ftxui::Color color)
+    : WidgetBase(pvgroup, pv_name), plot_(std::make_shared<Plot>()) {
+    plot_->handler = handler_;
+    plot_->color = color;
+    pvgroup.set_monitor(pv_name_, plot_->value);
+    component_ = ftxui::Renderer([plot = plot_] { return Plot::render(plot, 0, 0); });
+}
+
+WaveformWidget::WaveformWidget(App& app, const std::string& pv_name, ftxui::Color color)
+    : WidgetBase(app.pvgroup, app.args, pv_name), plot_(std::make_shared<Plot>()) {
+    plot_->handler = handler_;
+    plot_->color = color;
+    app.pvgroup.set_monitor(pv_name_, plot_->value);
+    component_ = ftxui::Renderer([plot = plot_] { return Plot::render(plot, 0, 0); });
+}
+
+void WaveformWidget::add_trace(const WaveformWidget& other) { plot_->traces.push_back(other.plot_); }
+
+void WaveformWidget::set_range(double low, double high) {
+    plot_->low = low;
+    plot_->high = high;
+}
+
+const SharedArray<double>& WaveformWidget::value() const { return plot_->value; }
+
+const WaveformEnvelope& WaveformWidget::envelope(size_t columns) const { return plot_->get_envelope(columns); }
+
+ftxui::Element WaveformWidget::render(int width, int height) const { return Plot::render(plot_, width, height); }
+
+// State shared by copies of a StripChartWidget and by widgets drawing its trace
+struct StripChartWidget::Chart {
+    std::shared_ptr<PVHandler> handler;
+    ftxui::Color color;
+    SampleHistory history;
+    double value = 0.0; // monitored, so sync() reports new data and the screen is redrawn
+    double window_seconds;
+    std::vector<std::shared_ptr<Chart>> traces; // drawn on this chart's canvas
+    double low = 0.0;                           // fixed range, if low < high
+    double high = 0.0;
+    WaveformEnvelope envelope; // reused by every frame
+    size_t listener = 0;
+
+    Chart(std::shared_ptr<PVHandler> pv, ftxui::Color color, double window_seconds, size_t capacity)
+        : handler(std::move(pv)), color(color), history(capacity), window_seconds(window_seconds) {
+        // A viewer which is never hidden, so the history has no gaps
+        handler->add_viewer();
+        listener = handler->add_update_listener([this](const PVHandler&, const epics::pvData::PVStructure& root) {
+            this->record(root);
+        });
+    }
+
+    ~Chart() {
+        handler->remove_update_listener(listener);
+        handler->remove_viewer();
+    }
+
+    Chart(const Chart&) = delete;
+    Chart& operator=(const Chart&) = delete;
+
+    // Called on the PVA callback thread with every decoded update
+    void record(const epics::pvData::PVStructure& root) {
+        namespace pvd = epics::pvData;
+        auto value_field = root.getSubField<pvd::PVScalar>("value");
+        if (!value_field || !pvd::ScalarTypeFunc::isNumeric(value_field->getScalar()->getScalarType())) {
+            return;
+        }
+        double time;
+        auto secs = root.getSubField<pvd::PVScalar>("timeStamp.secondsPastEpoch");
+        auto nsecs = root.getSubField<pvd::PVScalar>("timeStamp.nanoseconds");
+        if (secs && nsecs) {
+            time = secs->getAs<double>() + nsecs->getAs<double>() * 1e-9;
+        } else {
+            time = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+        history.push(time, value_field->getAs<double>());
+    }
+
+    void draw(ftxui::Canvas& canvas) {
+        const size_t columns = canvas.width();
+        if (columns == 0 || canvas.height() <= 0 || !(window_seconds > 0.0)) {
+            return;
+        }
+        std::vector<Chart*> charts = {this};
+        for (const auto& trace : traces) {
+            charts.push_back(trace.get());
+        }
+
+        // Server clocks may be ahead of ours, the newest sample is always shown
+        double end = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+        for (const Chart* chart : charts) {
+            if (auto newest = chart->history.newest()) {
+                end = std::max(end, newest->time);
+            }
+        }
+
+        std::vector<const WaveformEnvelope*> envelopes;
+        for (Chart* chart : charts) {
+            PVTUI_TRACE("StripChartWidget envelope", chart->handler->name.c_str());
+            chart->history.envelope(end, columns, window_seconds / columns, chart->envelope);
+            envelopes.push_back(&chart->envelope);
+        }
+
+        double lo = low;
+        double hi = high;
+        if (!(lo < hi) && !fit_range(envelopes, lo, hi)) {
+            return;
+        }
+        for (size_t i = 0; i < charts.size(); i++) {
+            draw_envelope(canvas, *envelopes[i], lo, hi, charts[i]->color);
+        }
+    }
+
+    // The element keeps the chart alive until it is drawn
+    static ftxui::Element render(const std::shared_ptr<Chart>& chart, int width, int height) {
+        return make_canvas(width, height, [chart](ftxui::Canvas& canvas) { chart->draw(canvas); });
+    }
+};
+
+StripChartWidget::StripChartWidget(PVGroup& pvgroup, const ArgParser& args, const std::string& pv_name,
+                                   double window_seconds, ftxui::Color color, size_t capacity)
+    : WidgetBase(pvgroup, args, pv_name),
+      chart_(std::make_shared<Chart>(handler_, color, window_seconds, capacity)) {
+    pvgroup.set_monitor(pv_name_, chart_->value);
+    component_ = ftxui::Renderer([chart = chart_] { return Chart::render(chart, 0, 0); });
+}
+
+StripChartWidget::StripChartWidget(PVGroup& pvgroup, const std::string& pv_name, double window_seconds,
+                                   ftxui::Color color, size_t capacity)
+    : WidgetBase(pvgroup, pv_name), chart_(std::make_shared<Chart>(handler_, color, window_seconds, capacity)) {
+    pvgroup.set_monitor(pv_name_, chart_->value);
+    component_ = ftxui::Renderer([chart = chart_] { return Chart::render(chart, 0, 0); });
+}
+
+StripChartWidget::StripChartWidget(App& app, const std::string& pv_name, double window_seconds,
+                                   ftxui::Color color, size_t capacity)
+    : WidgetBase(app.pvgroup, app.args, pv_name),
+      chart_(std::make_shared<Chart>(handler_, color, window_seconds, capacity)) {
+    app.pvgroup.set_monitor(pv_name_, chart_->value);
+    component_ = ftxui::Renderer([chart = chart_] { return Chart::render(chart, 0, 0); });
+}
+
+void StripChartWidget::add_trace(const StripChartWidget& other) { chart_->traces.push_back(other.chart_); }
+
+void StripChartWidget::set_range(double low, double high) {
+    chart_->low = low;
+    chart_->high = high;
+}
+
+void StripChartWidget::set_window(double seconds) { chart_->window_seconds = seconds; }
+
+double StripChartWidget::value() const { return chart_->value; }
+
+const SampleHistory& StripChartWidget::history() const { return chart_->history; }
+
+ftxui::Element StripChartWidget::render(int width, int height) const { return Chart::render(chart_, width, height); }
+
 } // namespace pvtui
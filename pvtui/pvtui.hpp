@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <string>
 #include <thread>
@@ -14,6 +15,8 @@
 #include <ftxui/screen/color.hpp>
 
 #include <pvtui/argh.h>
+#include <pvtui/decimate.hpp>
+#include <pvtui/history.hpp>
 #include <pvtui/pvgroup.hpp>
 
 namespace pvtui {
@@ -55,6 +58,23 @@ enum class ChoiceStyle {
 ///< Type alias for input transformation function.
 using InputTransform = std::function<ftxui::Element(ftxui::InputState)>;
 
+/**
+ * @brief What ended a wait_for_events() call.
+ */
+enum class WaitResult {
+    None,   ///< The timeout expired, the notifier was signaled, or a signal interrupted the wait.
+    Input,  ///< stdin has input available.
+    Closed, ///< stdin was hung up or is in error, e.g. the terminal went away.
+};
+
+/**
+ * @brief Blocks until there is terminal input on stdin or the notifier is signaled.
+ * @param notifier The UpdateNotifier to wait on, typically from PVGroup::notifier().
+ * @param timeout_ms Maximum time to wait in milliseconds. Negative values wait indefinitely.
+ * @return Whether stdin has input, was closed, or neither.
+ */
+WaitResult wait_for_events(UpdateNotifier& notifier, int timeout_ms);
+
 /**
  * @brief Parses command-line arguments for PVTUI applications.
  *
@@ -106,6 +126,14 @@ class ArgParser {
 
     std::unordered_map<std::string, std::string> macros; ///< Parsed macros (e.g., "P=VAL").
     std::string provider = "ca";                         ///< The EPICS provider type (e.g., "ca", "pva").
+    bool stats = false;                                  ///< Show the statistics overlay (--stats).
+    std::string trace;                                   ///< Chrome trace output file (--trace).
+    bool headless = false;                               ///< Record PV updates instead of drawing (--headless).
+    std::string format = "csv";                          ///< Headless output format (--format).
+    std::string output;                                  ///< Headless output file, stdout if empty (--output).
+    double max_rate = 0.0;                               ///< Headless per-PV rate limit in Hz (--max-rate).
+    size_t max_connects = 64;                            ///< Channels connecting at once, 0 for no limit (--max-connects).
+    size_t decoders = 0;                                 ///< Decode threads, 0 decodes on the callback thread (--decoders).
 
   private:
     argh::parser cmdl_; ///< Internal argh parser instance.
@@ -126,6 +154,19 @@ class ArgParser {
     std::unordered_map<std::string, std::string> get_macro_dict(std::string all_macros);
 };
 
+/**
+ * @brief Frame statistics of App's default main loop.
+ */
+struct RenderStats {
+    uint64_t frames = 0;         ///< Frames drawn for new PV data or input.
+    uint64_t frames_skipped = 0; ///< Updates merged into a later frame by the FPS cap or a full terminal.
+    double last_frame_ms = 0.0;  ///< Time taken to draw the most recent frame.
+    double avg_frame_ms = 0.0;   ///< Moving average of the frame time.
+    double last_sync_ms = 0.0;   ///< Time taken by the most recent PVGroup::sync().
+    double avg_sync_ms = 0.0;    ///< Moving average of the sync time.
+    uint64_t bytes_written = 0;  ///< Bytes written to the terminal through std::cout.
+};
+
 /**
  * @brief Convenience struct for managing a TUI application
  *
@@ -143,11 +184,30 @@ struct App {
     App(int argc, char* argv[]);
 
     /**
-     * @brief Runs the main FTXUI loop
+     * @brief Runs the main FTXUI loop, or records PV updates if --headless was given
+     *
+     * In headless mode nothing is drawn. Every update of the PVs in pvgroup is written
+     * with an UpdateRecorder to --output (default stdout) in the --format given (csv or
+     * jsonl) until SIGINT or SIGTERM. Updates are only skipped above --max-rate, if given.
+     *
+     * The default loop blocks until there is terminal input or new PV data, so an idle
+     * application does not wake up. Input is drawn right away. PV updates are drawn at
+     * most max_fps times per second, with bursts merged into one frame, and are held back
+     * while the terminal's output queue is backed up.
      * @param renderer The ftxui::Component which defines the application layout
-     * @param poll_period_ms Render loop polling period in milliseconds
+     * @param poll_period_ms Maximum time in milliseconds to wait for events before
+     * running the loop again. Negative values wait indefinitely.
      */
-    void run(const ftxui::Component& renderer, int poll_period_ms = 100);
+    void run(const ftxui::Component& renderer, int poll_period_ms = -1);
+
+    /// @brief Maximum frames per second drawn for PV updates. Input is always drawn right away.
+    double max_fps = 60.0;
+
+    /// @brief Frame statistics, updated by the default main loop.
+    RenderStats render_stats;
+
+    /// @brief Show the statistics overlay. Initialized from --stats and toggled with F12.
+    bool show_stats = false;
 
     /// @brief The main loop function to run with App::run. Can be redefined by the user
     std::function<void(App&, const ftxui::Component&, int)> main_loop;
@@ -172,7 +232,7 @@ class WidgetBase {
      * @brief Gets the PV name associated with the widget.
      * @return The fully expanded PV name.
      */
-    std::string pv_name() const;
+    const std::string& pv_name() const;
 
     /**
      * @brief Gets the underlying FTXUI component for rendering.
@@ -187,6 +247,28 @@ class WidgetBase {
      */
     bool connected() const;
 
+    /**
+     * @brief Gets the generation of the widget's PV, see PVHandler::generation().
+     * @return A counter which changes whenever the widget's contents may have changed.
+     */
+    uint64_t generation() const;
+
+    /**
+     * @brief Shows or hides the widget, e.g. when its tab is selected or deselected.
+     *
+     * The PV's updates are paused while every widget of the PV is hidden, see
+     * PVHandler::pause(). The widget keeps showing the last value when it is visible again.
+     * Copies of a widget share its visibility.
+     * @param visible False to pause the PV's updates for this widget.
+     */
+    void set_visible(bool visible);
+
+    /**
+     * @brief Checks if the widget is visible, see set_visible().
+     * @return True unless hidden with set_visible(false).
+     */
+    bool visible() const;
+
   protected:
     /**
      * @brief Constructs a WidgetBase and registers the PV with a PVGroup.
@@ -206,10 +288,74 @@ class WidgetBase {
     WidgetBase(PVGroup& pvgroup, const std::string& pv_name);
 
     PVGroup& pvgroup_;                                      ///< The PVGroup
-    std::string pv_name_;                                   ///< The PV name.
+    InternedString pv_name_;                                ///< The PV name.
     ftxui::Component component_;                            ///< Underlying FTXUI component.
     bool connected_;                                        ///< Boolean for PV connection status
     std::shared_ptr<ConnectionMonitor> connection_monitor_; ///< Monitors PV connection status.
+    std::shared_ptr<PVHandler> handler_;                    ///< Handler of the widget's PV.
+
+  private:
+    /**
+     * @brief Registers the widget as a viewer of its PV for as long as any copy exists.
+     */
+    struct View {
+        std::shared_ptr<PVHandler> pv;
+        bool visible = true;
+        explicit View(std::shared_ptr<PVHandler> pv);
+        ~View();
+    };
+    std::shared_ptr<View> view_; ///< Shared by copies of the widget.
+};
+
+/**
+ * @brief Caches an ftxui::Element built from a set of widgets.
+ *
+ * The element is rebuilt only when the generation of one of the tracked widgets changed
+ * or after terminal input, which may change the focus or contents of components. Every
+ * widget drawn in the element must be tracked, otherwise its updates won't be shown.
+ */
+class ElementCache {
+  public:
+    /**
+     * @brief Rebuilds the cached element when needed whenever one of these widgets changes.
+     * @param widgets The widgets drawn in the cached element.
+     */
+    template <typename... Widgets> void track(const Widgets&... widgets) {
+        (widgets_.push_back(&static_cast<const WidgetBase&>(widgets)), ...);
+    }
+
+    /**
+     * @brief Gets the cached element, rebuilding it if any tracked widget changed.
+     * @param build Function which builds the element.
+     * @return The cached or newly built element.
+     */
+    template <typename F> ftxui::Element get(F&& build) {
+        uint64_t key = epoch_.load(std::memory_order_relaxed);
+        for (const WidgetBase* widget : widgets_) {
+            key += widget->generation();
+        }
+        if (!element_ || key != key_) {
+            element_ = build();
+            key_ = key;
+        }
+        return element_;
+    }
+
+    /**
+     * @brief Forces the next get() to rebuild the element.
+     */
+    void invalidate() { element_ = nullptr; }
+
+    /**
+     * @brief Forces every ElementCache to rebuild. Called by App's main loop on input events.
+     */
+    static void invalidate_all() { epoch_.fetch_add(1, std::memory_order_relaxed); }
+
+  private:
+    std::vector<const WidgetBase*> widgets_; ///< Tracked widgets.
+    ftxui::Element element_;                 ///< Cached element.
+    uint64_t key_ = 0;                       ///< Sum of the generations element_ was built with.
+    static inline std::atomic<uint64_t> epoch_{0}; ///< Incremented by invalidate_all().
 };
 
 /**
@@ -383,7 +529,191 @@ class ChoiceWidget : public WidgetBase {
     const PVEnum& value() const;
 
   private:
+    struct Labels;
+
     std::shared_ptr<PVEnum> value_ptr_;
+    std::shared_ptr<Labels> labels_; ///< Gives FTXUI the choices of value_ptr_.
+};
+
+/**
+ * @brief Plots an array PV as a trace on a braille canvas.
+ *
+ * The waveform is reduced to the minimum and maximum of the samples in each canvas column
+ * with minmax_decimate(), so spikes stay visible however many samples the PV has. The
+ * reduced waveform is cached until the PV updates or the canvas width changes. Traces of
+ * other WaveformWidgets can be drawn on the same canvas with add_trace(). Copies of a
+ * widget share its value, traces, and range.
+ */
+class WaveformWidget : public WidgetBase {
+  public:
+    /**
+     * @brief Constructs a WaveformWidget with macro expansion.
+     * @param pvgroup The PVGroup managing the PVs used in this widget.
+     * @param args ArgParser for macro replacement.
+     * @param pv_name The PV name with macros, e.g. "$(P)$(M):Trace".
+     * @param color Color of the trace.
+     */
+    WaveformWidget(PVGroup& pvgroup, const ArgParser& args, const std::string& pv_name,
+                   ftxui::Color color = ftxui::Color::Default);
+
+    /**
+     * @brief Constructs a WaveformWidget with an expanded PV name.
+     * @param pvgroup The PVGroup managing the PVs used in this widget.
+     * @param pv_name The PV name.
+     * @param color Color of the trace.
+     */
+    WaveformWidget(PVGroup& pvgroup, const std::string& pv_name, ftxui::Color color = ftxui::Color::Default);
+
+    /**
+     * @brief Constructs a WaveformWidget from an App class
+     * @param app A reference to the App.
+     * @param pv_name The PV name.
+     * @param color Color of the trace.
+     */
+    WaveformWidget(App& app, const std::string& pv_name, ftxui::Color color = ftxui::Color::Default);
+
+    /**
+     * @brief Draws the trace of another widget on this widget's canvas, with its own color.
+     *
+     * The other widget must not draw this one in turn.
+     * @param other The widget whose trace to add.
+     */
+    void add_trace(const WaveformWidget& other);
+
+    /**
+     * @brief Fixes the vertical range of the plot.
+     *
+     * By default the range is fitted to the samples of all traces. Samples outside a
+     * fixed range are clipped.
+     * @param low Value at the bottom of the canvas.
+     * @param high Value at the top of the canvas. Must be greater than low.
+     */
+    void set_range(double low, double high);
+
+    /**
+     * @brief Gets the current waveform.
+     * @return The samples of the most recent update, shared with the monitor.
+     */
+    const SharedArray<double>& value() const;
+
+    /**
+     * @brief Gets the waveform reduced to a number of columns, recomputing it only if the
+     * PV updated or the number of columns changed since the last call.
+     * @param columns Number of columns, e.g. the canvas width in dots.
+     * @return The cached envelope.
+     */
+    const WaveformEnvelope& envelope(size_t columns) const;
+
+    /**
+     * @brief Renders the traces on a canvas.
+     * @param width Canvas width in braille dots, two per cell.
+     * @param height Canvas height in braille dots, four per cell.
+     * @return The canvas element. It fills the available space if width or height is zero.
+     */
+    ftxui::Element render(int width = 0, int height = 0) const;
+
+  private:
+    struct Plot;
+
+    std::shared_ptr<Plot> plot_;
+};
+
+/**
+ * @brief Plots the recent history of a scalar PV, scrolling with time.
+ *
+ * Every update of the PV is recorded with its server timestamp in a SampleHistory, which
+ * is allocated up front, so memory is bounded by the capacity however long the chart runs.
+ * The history is decimated into canvas columns as it is recorded, so drawing a frame
+ * costs O(width) rather than O(history). A strip chart keeps recording while hidden, so
+ * its PV is never paused by WidgetBase::set_visible(). The chart scrolls whenever the
+ * screen is redrawn. Copies of a widget share its history, traces, and range.
+ */
+class StripChartWidget : public WidgetBase {
+  public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 14; ///< Samples kept by default.
+
+    /**
+     * @brief Constructs a StripChartWidget with macro expansion.
+     * @param pvgroup The PVGroup managing the PVs used in this widget.
+     * @param args ArgParser for macro replacement.
+     * @param pv_name The PV name with macros, e.g. "$(P)$(M).RBV".
+     * @param window_seconds Time span shown on the chart.
+     * @param color Color of the trace.
+     * @param capacity Maximum number of samples kept.
+     */
+    StripChartWidget(PVGroup& pvgroup, const ArgParser& args, const std::string& pv_name, double window_seconds,
+                     ftxui::Color color = ftxui::Color::Default, size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * @brief Constructs a StripChartWidget with an expanded PV name.
+     * @param pvgroup The PVGroup managing the PVs used in this widget.
+     * @param pv_name The PV name.
+     * @param window_seconds Time span shown on the chart.
+     * @param color Color of the trace.
+     * @param capacity Maximum number of samples kept.
+     */
+    StripChartWidget(PVGroup& pvgroup, const std::string& pv_name, double window_seconds,
+                     ftxui::Color color = ftxui::Color::Default, size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * @brief Constructs a StripChartWidget from an App class
+     * @param app A reference to the App.
+     * @param pv_name The PV name.
+     * @param window_seconds Time span shown on the chart.
+     * @param color Color of the trace.
+     * @param capacity Maximum number of samples kept.
+     */
+    StripChartWidget(App& app, const std::string& pv_name, double window_seconds,
+                     ftxui::Color color = ftxui::Color::Default, size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * @brief Draws the trace of another strip chart on this widget's canvas, with its own color.
+     *
+     * The other widget must not draw this one in turn.
+     * @param other The widget whose trace to add.
+     */
+    void add_trace(const StripChartWidget& other);
+
+    /**
+     * @brief Fixes the vertical range of the chart.
+     *
+     * By default the range is fitted to the samples of all traces in the window.
+     * @param low Value at the bottom of the canvas.
+     * @param high Value at the top of the canvas. Must be greater than low.
+     */
+    void set_range(double low, double high);
+
+    /**
+     * @brief Changes the time span shown on the chart.
+     * @param seconds Time span. Samples older than the capacity allows are not shown.
+     */
+    void set_window(double seconds);
+
+    /**
+     * @brief Gets the current value of the PV.
+     * @return The newest value copied by sync().
+     */
+    double value() const;
+
+    /**
+     * @brief Gets the recorded history.
+     * @return The history, filled on the PVA callback thread.
+     */
+    const SampleHistory& history() const;
+
+    /**
+     * @brief Renders the traces on a canvas. The newest sample or the current time, whichever
+     * is later, is at the right edge.
+     * @param width Canvas width in braille dots, two per cell.
+     * @param height Canvas height in braille dots, four per cell.
+     * @return The canvas element. It fills the available space if width or height is zero.
+     */
+    ftxui::Element render(int width = 0, int height = 0) const;
+
+  private:
+    struct Chart;
+
+    std::shared_ptr<Chart> chart_;
 };
 
 /**
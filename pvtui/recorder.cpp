@@ -0,0 +1,299 @@
+#include <pvtui/recorder.hpp>
+#include <pvtui/trace.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+
+#include <pv/pvData.h>
+
+namespace pvtui {
+
+namespace {
+namespace pvd = epics::pvData;
+
+void append_json_string(std::string& out, const std::string& str) {
+    out.push_back('"');
+    for (const char c : str) {
+        switch (c) {
+        case '"':
+            out.append("\\\"");
+            break;
+        case '\\':
+            out.append("\\\\");
+            break;
+        case '\n':
+            out.append("\\n");
+            break;
+        case '\r':
+            out.append("\\r");
+            break;
+        case '\t':
+            out.append("\\t");
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+                out.append(buf);
+            } else {
+                out.push_back(c);
+            }
+        }
+    }
+    out.push_back('"');
+}
+
+// Quotes a CSV field if it contains a separator, quote, or line break
+void append_csv_field(std::string& out, const std::string& field) {
+    if (field.find_first_of(",\"\r\n") == std::string::npos) {
+        out.append(field);
+        return;
+    }
+    out.push_back('"');
+    for (const char c : field) {
+        if (c == '"') {
+            out.push_back('"');
+        }
+        out.push_back(c);
+    }
+    out.push_back('"');
+}
+
+// Enough digits to round trip. JSON has no NaN or infinity, so those are null.
+void append_double(std::string& out, double value, bool json) {
+    if (json && !std::isfinite(value)) {
+        out.append("null");
+        return;
+    }
+    char buf[32];
+    const int len = std::snprintf(buf, sizeof(buf), "%.17g", value);
+    out.append(buf, len);
+}
+
+void append_scalar(std::string& out, const pvd::PVScalar& scalar, bool json) {
+    const pvd::ScalarType type = scalar.getScalar()->getScalarType();
+    if (type == pvd::pvString) {
+        if (json) {
+            append_json_string(out, scalar.getAs<std::string>());
+        } else {
+            out.append(scalar.getAs<std::string>());
+        }
+    } else if (type == pvd::pvBoolean) {
+        out.append(scalar.getAs<pvd::boolean>() ? "true" : "false");
+    } else if (pvd::ScalarTypeFunc::isInteger(type)) {
+        out.append(std::to_string(scalar.getAs<pvd::int64>()));
+    } else if (pvd::ScalarTypeFunc::isUInteger(type)) {
+        out.append(std::to_string(scalar.getAs<pvd::uint64>()));
+    } else {
+        append_double(out, scalar.getAs<double>(), json);
+    }
+}
+
+// Arrays are always written as JSON arrays, quoted as a single field in CSV
+void append_array(std::string& out, const pvd::PVScalarArray& array) {
+    const pvd::ScalarType type = array.getScalarArray()->getElementType();
+    out.push_back('[');
+    if (type == pvd::pvString) {
+        pvd::shared_vector<const std::string> vals;
+        array.getAs(vals);
+        for (size_t i = 0; i < vals.size(); i++) {
+            if (i) {
+                out.push_back(',');
+            }
+            append_json_string(out, vals[i]);
+        }
+    } else if (pvd::ScalarTypeFunc::isInteger(type) || pvd::ScalarTypeFunc::isUInteger(type) ||
+               type == pvd::pvBoolean) {
+        pvd::shared_vector<const pvd::int64> vals;
+        array.getAs(vals);
+        for (size_t i = 0; i < vals.size(); i++) {
+            if (i) {
+                out.push_back(',');
+            }
+            out.append(std::to_string(vals[i]));
+        }
+    } else {
+        pvd::shared_vector<const double> vals;
+        array.getAs(vals);
+        for (size_t i = 0; i < vals.size(); i++) {
+            if (i) {
+                out.push_back(',');
+            }
+            append_double(out, vals[i], true);
+        }
+    }
+    out.push_back(']');
+}
+
+// Formats the value field. Enums are written as their selected choice.
+void append_value(std::string& out, const pvd::PVStructure& root, bool json) {
+    const pvd::PVField* value = root.getSubField("value").get();
+    if (!value) {
+        out.append(json ? "null" : "");
+        return;
+    }
+    if (auto scalar = dynamic_cast<const pvd::PVScalar*>(value)) {
+        append_scalar(out, *scalar, json);
+        return;
+    }
+    if (auto array = dynamic_cast<const pvd::PVScalarArray*>(value)) {
+        append_array(out, *array);
+        return;
+    }
+    if (auto structure = dynamic_cast<const pvd::PVStructure*>(value)) {
+        auto index = structure->getSubField<pvd::PVInt>("index");
+        auto choices = structure->getSubField<pvd::PVStringArray>("choices");
+        if (index && choices) {
+            pvd::shared_vector<const std::string> vals = choices->view();
+            const pvd::int32 i = index->get();
+            const std::string choice = i >= 0 && static_cast<size_t>(i) < vals.size()
+                                           ? vals[i]
+                                           : std::to_string(i);
+            if (json) {
+                append_json_string(out, choice);
+            } else {
+                out.append(choice);
+            }
+            return;
+        }
+    }
+    std::ostringstream oss;
+    value->dumpValue(oss);
+    if (json) {
+        append_json_string(out, oss.str());
+    } else {
+        out.append(oss.str());
+    }
+}
+
+// Server time as seconds.nanoseconds, or the local time if there is no timeStamp
+void append_timestamp(std::string& out, const pvd::PVStructure& root) {
+    long long seconds = 0;
+    long nanoseconds = 0;
+    auto secs = root.getSubField<pvd::PVScalar>("timeStamp.secondsPastEpoch");
+    auto nsecs = root.getSubField<pvd::PVScalar>("timeStamp.nanoseconds");
+    if (secs && nsecs) {
+        seconds = secs->getAs<pvd::int64>();
+        nanoseconds = nsecs->getAs<pvd::int32>();
+    } else {
+        const auto now = std::chrono::system_clock::now().time_since_epoch();
+        const auto whole = std::chrono::duration_cast<std::chrono::seconds>(now);
+        seconds = whole.count();
+        nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(now - whole).count();
+    }
+    char buf[40];
+    const int len = std::snprintf(buf, sizeof(buf), "%lld.%09ld", seconds, nanoseconds);
+    out.append(buf, len);
+}
+} // namespace
+
+std::optional<RecordFormat> parse_record_format(std::string_view name) {
+    if (name == "csv") {
+        return RecordFormat::CSV;
+    }
+    if (name == "jsonl") {
+        return RecordFormat::JSONL;
+    }
+    return std::nullopt;
+}
+
+UpdateRecorder::UpdateRecorder(std::ostream& out, RecordFormat format, size_t buffer_size)
+    : out_(out), format_(format), buffer_size_(buffer_size) {
+    buffer_.reserve(buffer_size_);
+    this->write_header();
+}
+
+UpdateRecorder::UpdateRecorder(const std::string& path, RecordFormat format, size_t buffer_size)
+    : file_(path, std::ios::out | std::ios::trunc), out_(file_), format_(format), buffer_size_(buffer_size) {
+    if (!file_) {
+        throw std::runtime_error("Failed to open " + path + " for writing");
+    }
+    buffer_.reserve(buffer_size_);
+    this->write_header();
+}
+
+UpdateRecorder::~UpdateRecorder() {
+    for (auto& [pv, id] : listeners_) {
+        pv->remove_update_listener(id);
+    }
+    this->flush();
+}
+
+void UpdateRecorder::write_header() {
+    if (format_ == RecordFormat::CSV) {
+        buffer_.append("timestamp,pv,value\n");
+    }
+}
+
+void UpdateRecorder::attach(PVHandler& pv) {
+    const size_t id = pv.add_update_listener(
+        [this](const PVHandler& handler, const epics::pvData::PVStructure& root) {
+            this->record(handler.name, root);
+        });
+    listeners_.emplace_back(&pv, id);
+}
+
+void UpdateRecorder::attach(PVGroup& group) {
+    group.for_each([this](PVHandler& pv) { this->attach(pv); });
+}
+
+void UpdateRecorder::record(const std::string& pv_name, const epics::pvData::PVStructure& root) {
+    // Formatted outside the lock, reusing a per-thread buffer
+    thread_local std::string line;
+    line.clear();
+    if (format_ == RecordFormat::CSV) {
+        thread_local std::string value;
+        value.clear();
+        append_timestamp(line, root);
+        line.push_back(',');
+        append_csv_field(line, pv_name);
+        line.push_back(',');
+        append_value(value, root, false);
+        append_csv_field(line, value);
+    } else {
+        line.append("{\"timestamp\":");
+        append_timestamp(line, root);
+        line.append(",\"pv\":");
+        append_json_string(line, pv_name);
+        line.append(",\"value\":");
+        append_value(line, root, true);
+        line.push_back('}');
+    }
+    line.push_back('\n');
+
+    bool full;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        buffer_.append(line);
+        full = buffer_.size() >= buffer_size_;
+    }
+    records_.fetch_add(1, std::memory_order_relaxed);
+    if (full) {
+        this->flush();
+    }
+}
+
+void UpdateRecorder::flush() {
+    // Holding write_mutex_ while swapping keeps the blocks in order
+    const std::lock_guard<std::mutex> write_lock(write_mutex_);
+    thread_local std::string lines;
+    lines.clear();
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        lines.swap(buffer_);
+    }
+    this->write(lines);
+}
+
+void UpdateRecorder::write(const std::string& lines) {
+    PVTUI_TRACE("UpdateRecorder::write");
+    if (!lines.empty()) {
+        out_.write(lines.data(), static_cast<std::streamsize>(lines.size()));
+    }
+    out_.flush();
+}
+
+} // namespace pvtui
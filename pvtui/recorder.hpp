@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <pvtui/pvgroup.hpp>
+
+namespace pvtui {
+
+/**
+ * @brief Output formats of UpdateRecorder.
+ */
+enum class RecordFormat {
+    CSV,   ///< One "timestamp,pv,value" row per update, after a header row.
+    JSONL, ///< One {"timestamp":...,"pv":...,"value":...} object per line.
+};
+
+/**
+ * @brief Parses a record format name.
+ * @param name "csv" or "jsonl".
+ * @return The format, or std::nullopt if the name is not recognized.
+ */
+std::optional<RecordFormat> parse_record_format(std::string_view name);
+
+/**
+ * @brief Writes every monitor update of the attached PVs to a stream, one line per update.
+ *
+ * Lines are formatted on the PVA callback threads as updates are decoded, so no update is
+ * lost between two sync() calls. Updates are only skipped if a PV was given a maximum rate
+ * with PVHandler::set_max_rate(). The timestamp is the server's timeStamp field in seconds
+ * since the POSIX epoch, or the local time if the PV doesn't have one.
+ *
+ * Lines are collected in memory and written once the buffer is full or flush() is called.
+ * Attached handlers must outlive the recorder.
+ */
+class UpdateRecorder {
+  public:
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 1 << 16; ///< Bytes buffered before writing.
+
+    /**
+     * @brief Constructs a recorder writing to a stream, e.g. std::cout.
+     * @param out The stream to write to. Must outlive the recorder.
+     * @param format The output format.
+     * @param buffer_size Number of bytes buffered before writing to out.
+     */
+    UpdateRecorder(std::ostream& out, RecordFormat format, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+
+    /**
+     * @brief Constructs a recorder writing to a file, which is truncated.
+     * @param path The file to write to.
+     * @param format The output format.
+     * @param buffer_size Number of bytes buffered before writing to the file.
+     * @throws std::runtime_error if the file cannot be opened.
+     */
+    UpdateRecorder(const std::string& path, RecordFormat format, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+
+    /**
+     * @brief Detaches from all handlers and writes the remaining buffered lines.
+     */
+    ~UpdateRecorder();
+
+    UpdateRecorder(const UpdateRecorder&) = delete;
+    UpdateRecorder& operator=(const UpdateRecorder&) = delete;
+
+    /**
+     * @brief Starts recording the updates of a PV. Its newest value is recorded right away.
+     * @param pv The handler to record.
+     */
+    void attach(PVHandler& pv);
+
+    /**
+     * @brief Starts recording the updates of every PV in a group.
+     * @param group The group to record.
+     */
+    void attach(PVGroup& group);
+
+    /**
+     * @brief Formats one update and appends it to the buffer. Safe to call from any thread.
+     * @param pv_name Name of the PV.
+     * @param root The full PVStructure of the update.
+     */
+    void record(const std::string& pv_name, const epics::pvData::PVStructure& root);
+
+    /**
+     * @brief Writes the buffered lines to the output stream and flushes it.
+     */
+    void flush();
+
+    /**
+     * @brief Gets the number of updates recorded.
+     * @return The number of lines written or buffered, excluding the CSV header.
+     */
+    uint64_t records() const { return records_.load(std::memory_order_relaxed); }
+
+  private:
+    std::ofstream file_;                 ///< Output file, if constructed with a path.
+    std::ostream& out_;                  ///< Output stream.
+    RecordFormat format_;                ///< Output format.
+    size_t buffer_size_;                 ///< Bytes buffered before writing.
+    std::mutex mutex_;                   ///< Protects buffer_.
+    std::string buffer_;                 ///< Formatted lines not yet written.
+    std::mutex write_mutex_;             ///< Serializes writes to out_.
+    std::atomic<uint64_t> records_{0};   ///< See records().
+    std::vector<std::pair<PVHandler*, size_t>> listeners_; ///< Attached handlers and listener ids.
+
+    /**
+     * @brief Writes the header row, if the format has one.
+     */
+    void write_header();
+
+    /**
+     * @brief Writes a block of lines to out_.
+     * @param lines The lines to write.
+     */
+    void write(const std::string& lines);
+};
+
+} // namespace pvtui
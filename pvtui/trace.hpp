@@ -0,0 +1,250 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <string>
+
+namespace pvtui {
+
+/**
+ * @brief Opt-in recording of timestamped spans, exported as Chrome trace JSON.
+ *
+ * Spans are written to a fixed size ring buffer, so the newest events are kept when
+ * it wraps. The file can be opened in chrome://tracing or https://ui.perfetto.dev.
+ * While tracing is disabled, a span costs one atomic load and a branch.
+ */
+namespace trace {
+
+constexpr size_t BUFFER_SIZE = 1 << 16; ///< Number of spans kept in the ring buffer.
+constexpr size_t DETAIL_SIZE = 48;      ///< Maximum length of a span's detail string, e.g. a PV name.
+
+/**
+ * @brief A completed span.
+ */
+struct Event {
+    const char* name = nullptr;   ///< Span name, must be a string literal.
+    char detail[DETAIL_SIZE] = {}; ///< Optional detail, truncated copy.
+    uint64_t start_ns = 0;        ///< Start time relative to the trace epoch.
+    uint64_t dur_ns = 0;          ///< Duration.
+    uint32_t tid = 0;             ///< Small integer identifying the recording thread.
+};
+
+namespace impl {
+constexpr uint64_t NO_EVENT = std::numeric_limits<uint64_t>::max();
+constexpr size_t DETAIL_WORDS = DETAIL_SIZE / sizeof(uint64_t);
+static_assert(DETAIL_SIZE % sizeof(uint64_t) == 0, "detail is stored in whole words");
+
+// A ring buffer entry. dump() reads entries while other threads write them, so every field
+// is a relaxed atomic and seq makes the fields consistent: it holds the index of the span
+// in the entry, stored with release once the fields are written, or NO_EVENT while they are.
+struct Slot {
+    std::atomic<uint64_t> seq{NO_EVENT};
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> detail[DETAIL_WORDS];
+    std::atomic<uint64_t> start_ns{0};
+    std::atomic<uint64_t> dur_ns{0};
+    std::atomic<uint32_t> tid{0};
+};
+
+inline std::atomic<bool> enabled{false};
+inline std::atomic<bool> dump_requested{false};
+inline std::atomic<uint64_t> next_index{0};
+inline std::unique_ptr<Slot[]> buffer;
+inline std::string path;
+inline const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+inline uint32_t thread_id() {
+    static std::atomic<uint32_t> next_tid{1};
+    thread_local const uint32_t tid = next_tid.fetch_add(1, std::memory_order_relaxed);
+    return tid;
+}
+
+inline void on_signal(int) { dump_requested.store(true, std::memory_order_relaxed); }
+
+// Copies the span with the given index out of its slot. Returns false if the slot holds
+// another span or is being written.
+inline bool read_slot(const Slot& slot, uint64_t index, Event& event) {
+    if (slot.seq.load(std::memory_order_acquire) != index) {
+        return false;
+    }
+    event.name = slot.name.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < DETAIL_WORDS; i++) {
+        const uint64_t word = slot.detail[i].load(std::memory_order_relaxed);
+        std::memcpy(event.detail + i * sizeof(word), &word, sizeof(word));
+    }
+    event.detail[DETAIL_SIZE - 1] = '\0';
+    event.start_ns = slot.start_ns.load(std::memory_order_relaxed);
+    event.dur_ns = slot.dur_ns.load(std::memory_order_relaxed);
+    event.tid = slot.tid.load(std::memory_order_relaxed);
+    // Overwritten while it was copied if seq changed since
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.seq.load(std::memory_order_relaxed) == index;
+}
+
+inline void write_escaped(std::ostream& out, const char* str) {
+    for (; *str; str++) {
+        const char c = *str;
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) >= 0x20) {
+            out << c;
+        }
+    }
+}
+} // namespace impl
+
+/**
+ * @brief Gets the current time relative to the trace epoch.
+ * @return Nanoseconds since the trace epoch.
+ */
+inline uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                impl::epoch)
+        .count();
+}
+
+/**
+ * @brief Checks if tracing is enabled.
+ * @return True if spans are being recorded.
+ */
+inline bool enabled() { return impl::enabled.load(std::memory_order_acquire); }
+
+/**
+ * @brief Starts recording spans. SIGUSR1 requests a dump while running.
+ * @param path The file written by dump().
+ */
+inline void enable(const std::string& path) {
+    if (!impl::buffer) {
+        impl::buffer = std::make_unique<impl::Slot[]>(BUFFER_SIZE);
+    }
+    impl::path = path;
+    struct sigaction action = {};
+    action.sa_handler = impl::on_signal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &action, nullptr);
+    impl::enabled.store(true, std::memory_order_release);
+}
+
+/**
+ * @brief Records a completed span. Does nothing if tracing is disabled.
+ * @param name Span name, must be a string literal.
+ * @param detail Optional detail string, e.g. a PV name. May be nullptr.
+ * @param start_ns Start time from now_ns().
+ * @param end_ns End time from now_ns().
+ */
+inline void record(const char* name, const char* detail, uint64_t start_ns, uint64_t end_ns) {
+    if (!enabled()) {
+        return;
+    }
+    const uint64_t index = impl::next_index.fetch_add(1, std::memory_order_relaxed);
+    impl::Slot& slot = impl::buffer[index % BUFFER_SIZE];
+    slot.seq.store(impl::NO_EVENT, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.name.store(name, std::memory_order_relaxed);
+    char copy[DETAIL_SIZE] = {};
+    if (detail) {
+        std::strncpy(copy, detail, DETAIL_SIZE - 1);
+    }
+    for (size_t i = 0; i < impl::DETAIL_WORDS; i++) {
+        uint64_t word;
+        std::memcpy(&word, copy + i * sizeof(word), sizeof(word));
+        slot.detail[i].store(word, std::memory_order_relaxed);
+    }
+    slot.start_ns.store(start_ns, std::memory_order_relaxed);
+    slot.dur_ns.store(end_ns - start_ns, std::memory_order_relaxed);
+    slot.tid.store(impl::thread_id(), std::memory_order_relaxed);
+    slot.seq.store(index, std::memory_order_release);
+}
+
+/**
+ * @brief Checks and clears a dump request made with SIGUSR1.
+ * @return True if a dump was requested since the last call.
+ */
+inline bool take_dump_request() { return impl::dump_requested.exchange(false, std::memory_order_relaxed); }
+
+/**
+ * @brief Writes the spans in the ring buffer to the file given to enable().
+ *
+ * Spans which are being written or overwritten while dumping are left out.
+ * @return True if the file was written.
+ */
+inline bool dump() {
+    if (!impl::buffer) {
+        return false;
+    }
+    std::ofstream out(impl::path);
+    if (!out) {
+        return false;
+    }
+    const uint64_t end = impl::next_index.load(std::memory_order_acquire);
+    const uint64_t begin = end > BUFFER_SIZE ? end - BUFFER_SIZE : 0;
+    // Microseconds with ns resolution. The default 6 significant digits would lose it
+    // seconds into a session and switch to scientific notation after minutes.
+    out << std::fixed << std::setprecision(3);
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    Event event;
+    for (uint64_t i = begin; i < end; i++) {
+        if (!impl::read_slot(impl::buffer[i % BUFFER_SIZE], i, event) || !event.name) {
+            continue;
+        }
+        out << (first ? "\n" : ",\n") << "{\"name\":\"" << event.name
+            << "\",\"cat\":\"pvtui\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.tid
+            << ",\"ts\":" << event.start_ns / 1000.0 << ",\"dur\":" << event.dur_ns / 1000.0;
+        if (event.detail[0]) {
+            out << ",\"args\":{\"detail\":\"";
+            impl::write_escaped(out, event.detail);
+            out << "\"}";
+        }
+        out << "}";
+        first = false;
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+/**
+ * @brief Records the lifetime of a scope as a span.
+ */
+class Span {
+  public:
+    /**
+     * @brief Starts the span if tracing is enabled.
+     * @param name Span name, must be a string literal.
+     * @param detail Optional detail string, e.g. a PV name. Must outlive the Span.
+     */
+    explicit Span(const char* name, const char* detail = nullptr)
+        : name_(name), detail_(detail), start_ns_(enabled() ? now_ns() : 0) {}
+
+    ~Span() {
+        if (start_ns_) {
+            record(name_, detail_, start_ns_, now_ns());
+        }
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+  private:
+    const char* name_;
+    const char* detail_;
+    uint64_t start_ns_;
+};
+
+} // namespace trace
+} // namespace pvtui
+
+#define PVTUI_TRACE_CONCAT_(a, b) a##b
+#define PVTUI_TRACE_CONCAT(a, b) PVTUI_TRACE_CONCAT_(a, b)
+
+/// @brief Records the enclosing scope as a span named name, with an optional detail string.
+#define PVTUI_TRACE(...) ::pvtui::trace::Span PVTUI_TRACE_CONCAT(pvtui_trace_span_, __LINE__)(__VA_ARGS__)
@@ -0,0 +1,148 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <pv/pvData.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pvtui/pvgroup.hpp>
+
+// Counts heap allocations made on the calling thread while decoding and syncing
+// string array, enum, and numeric-as-string updates. In steady state none should
+// allocate.
+
+namespace pvd = epics::pvData;
+
+static thread_local bool t_counting = false;
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(std::size_t size) {
+    if (t_counting) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+constexpr int NUM_WARMUP = 10;
+constexpr int NUM_UPDATES = 10000;
+constexpr size_t NUM_STRINGS = 16;
+
+struct Update {
+    pvd::PVStructurePtr root;
+    pvd::BitSet changed;
+};
+
+static pvd::shared_vector<const std::string> make_strings(char fill) {
+    pvd::shared_vector<std::string> strings(NUM_STRINGS);
+    for (size_t i = 0; i < NUM_STRINGS; i++) {
+        strings[i] = std::string(40, fill) + std::to_string(i); // longer than any SSO buffer
+    }
+    return pvd::freeze(strings);
+}
+
+static Update make_string_array_update(char fill) {
+    auto type = pvd::getFieldCreate()
+                    ->createFieldBuilder()
+                    ->setId("epics:nt/NTScalarArray:1.0")
+                    ->addArray("value", pvd::pvString)
+                    ->createStructure();
+    Update update{pvd::getPVDataCreate()->createPVStructure(type), {}};
+    auto value = update.root->getSubFieldT<pvd::PVStringArray>("value");
+    value->replace(make_strings(fill));
+    update.changed.set(value->getFieldOffset());
+    return update;
+}
+
+static Update make_enum_update(char fill, int index) {
+    auto type = pvd::getFieldCreate()
+                    ->createFieldBuilder()
+                    ->setId("epics:nt/NTEnum:1.0")
+                    ->addNestedStructure("value")
+                    ->setId("enum_t")
+                    ->add("index", pvd::pvInt)
+                    ->addArray("choices", pvd::pvString)
+                    ->endNested()
+                    ->createStructure();
+    Update update{pvd::getPVDataCreate()->createPVStructure(type), {}};
+    update.root->getSubFieldT<pvd::PVInt>("value.index")->put(index);
+    update.root->getSubFieldT<pvd::PVStringArray>("value.choices")->replace(make_strings(fill));
+    update.changed.set(update.root->getSubFieldT<pvd::PVStructure>("value")->getFieldOffset());
+    return update;
+}
+
+static Update make_double_update(double value) {
+    auto type = pvd::getFieldCreate()
+                    ->createFieldBuilder()
+                    ->setId("epics:nt/NTScalar:1.0")
+                    ->add("value", pvd::pvDouble)
+                    ->createStructure();
+    Update update{pvd::getPVDataCreate()->createPVStructure(type), {}};
+    auto field = update.root->getSubFieldT<pvd::PVDouble>("value");
+    field->put(value);
+    update.changed.set(field->getFieldOffset());
+    return update;
+}
+
+template <typename T>
+static bool run(const std::string& label, pvtui::PVHandler& pv, const Update& a, const Update& b) {
+    T var{};
+    pv.set_monitor(var);
+
+    for (int i = 0; i < NUM_WARMUP; i++) {
+        const Update& u = i % 2 ? b : a;
+        pv.process_update(*u.root, u.changed);
+        pv.sync();
+    }
+
+    g_allocations = 0;
+    const auto start = std::chrono::steady_clock::now();
+    t_counting = true;
+    for (int i = 0; i < NUM_UPDATES; i++) {
+        const Update& u = i % 2 ? b : a;
+        pv.process_update(*u.root, u.changed);
+        pv.sync();
+    }
+    t_counting = false;
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    const size_t allocations = g_allocations.load();
+    std::cout << "  " << label << ": " << allocations << " allocations in " << NUM_UPDATES
+              << " updates, " << std::chrono::duration<double, std::nano>(elapsed).count() / NUM_UPDATES
+              << " ns/update\n";
+    return allocations == 0;
+}
+
+int main() {
+
+    std::cout << "[pvtui::PVHandler] allocation benchmark\n";
+
+    // The channels never connect, updates are fed directly with process_update()
+    pvas::StaticProvider server("bench");
+    pvac::ClientProvider provider(server.provider());
+    pvtui::PVHandler strings_pv(provider, "bench:strings");
+    pvtui::PVHandler enum_pv(provider, "bench:enum");
+    pvtui::PVHandler choices_pv(provider, "bench:choices");
+    pvtui::PVHandler number_pv(provider, "bench:number");
+
+    bool ok = true;
+    ok &= run<std::vector<std::string>>("string array", strings_pv, make_string_array_update('a'),
+                                        make_string_array_update('b'));
+    ok &= run<pvtui::PVEnum>("enum", enum_pv, make_enum_update('c', 1), make_enum_update('c', 2));
+    ok &= run<pvtui::PVEnum>("enum, new choices", choices_pv, make_enum_update('d', 1), make_enum_update('e', 2));
+    ok &= run<std::string>("double as string", number_pv, make_double_update(1.25), make_double_update(-1234.5));
+
+    if (!ok) {
+        std::cout << "[pvtui::PVHandler] FAILED: steady state updates allocated memory" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "[pvtui::PVHandler] No allocations in steady state" << std::endl;
+}
@@ -0,0 +1,110 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <pv/pvData.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pvtui/decode_pool.hpp>
+#include <pvtui/pvgroup.hpp>
+
+// Compares decoding a burst of large waveform updates on the calling thread, as the
+// PVA callback thread does by default, with decoding them on a DecodePool.
+
+namespace pvd = epics::pvData;
+
+constexpr size_t NUM_PVS = 48;
+constexpr size_t NUM_SAMPLES = 250000;
+constexpr int NUM_ROUNDS = 20;
+
+struct Update {
+    pvd::PVStructurePtr root;
+    pvd::BitSet changed;
+};
+
+static Update make_waveform_update(double offset) {
+    auto type = pvd::getFieldCreate()
+                    ->createFieldBuilder()
+                    ->setId("epics:nt/NTScalarArray:1.0")
+                    ->addArray("value", pvd::pvDouble)
+                    ->createStructure();
+    Update update{pvd::getPVDataCreate()->createPVStructure(type), {}};
+    pvd::shared_vector<double> samples(NUM_SAMPLES);
+    for (size_t i = 0; i < NUM_SAMPLES; i++) {
+        samples[i] = offset + static_cast<double>(i);
+    }
+    auto value = update.root->getSubFieldT<pvd::PVDoubleArray>("value");
+    value->replace(pvd::freeze(samples));
+    update.changed.set(value->getFieldOffset());
+    return update;
+}
+
+// Feeds every PV one update per round and waits until all of them are decoded.
+// Returns the mean time per round in ms.
+static double run(std::vector<std::unique_ptr<pvtui::PVHandler>>& pvs, const Update& a, const Update& b,
+                  pvtui::DecodePool* pool) {
+    auto round = [&](int i) {
+        const Update& u = i % 2 ? b : a;
+        for (auto& pv : pvs) {
+            pv->process_update(*u.root, u.changed);
+        }
+        if (pool) {
+            pool->wait_idle();
+        }
+    };
+
+    round(0); // warm up, sizes the monitored vectors
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 1; i <= NUM_ROUNDS; i++) {
+        round(i);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(elapsed).count() / NUM_ROUNDS;
+}
+
+int main() {
+
+    std::cout << "[pvtui::DecodePool] decode benchmark: " << NUM_PVS << " waveforms of " << NUM_SAMPLES
+              << " samples per round\n";
+
+    // The channels never connect, updates are fed directly with process_update()
+    pvas::StaticProvider server("bench");
+    pvac::ClientProvider provider(server.provider());
+    std::vector<std::unique_ptr<pvtui::PVHandler>> pvs;
+    std::vector<std::vector<double>> values(NUM_PVS);
+    for (size_t i = 0; i < NUM_PVS; i++) {
+        pvs.push_back(std::make_unique<pvtui::PVHandler>(provider, "bench:wave" + std::to_string(i)));
+        pvs.back()->set_monitor(values[i]);
+    }
+
+    const Update a = make_waveform_update(0.0);
+    const Update b = make_waveform_update(1.0);
+
+    const double inline_ms = run(pvs, a, b, nullptr);
+    std::cout << "  inline: " << inline_ms << " ms/round\n";
+
+    auto pool = std::make_shared<pvtui::DecodePool>();
+    for (auto& pv : pvs) {
+        pv->set_decode_pool(pool);
+    }
+    const double pooled_ms = run(pvs, a, b, pool.get());
+    std::cout << "  pooled (" << pool->size() << " threads): " << pooled_ms << " ms/round, "
+              << inline_ms / pooled_ms << "x\n";
+
+    // Every PV should hold the update fed in the last round
+    const Update& last = NUM_ROUNDS % 2 ? b : a;
+    const double first = last.root->getSubFieldT<pvd::PVDoubleArray>("value")->view()[0];
+    bool ok = true;
+    for (size_t i = 0; i < NUM_PVS; i++) {
+        pvs[i]->sync();
+        ok &= values[i].size() == NUM_SAMPLES && values[i][0] == first;
+    }
+    if (!ok) {
+        std::cout << "[pvtui::DecodePool] FAILED: pooled decode lost an update" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "[pvtui::DecodePool] Pooled decode matches inline" << std::endl;
+}
@@ -0,0 +1,77 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <pv/pvData.h>
+#include <pvtui/pvgroup.hpp>
+
+// Compares formatting numeric fields as text with an ostringstream and dumpValue, as
+// every numeric PV monitored as std::string used to, with pvtui::format_value.
+
+namespace pvd = epics::pvData;
+
+constexpr int NUM_ITERATIONS = 200000;
+constexpr size_t NUM_SAMPLES = 1000;
+constexpr int PRECISION = 3;
+
+static std::string stream_format(const pvd::PVField& field) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(PRECISION);
+    field.dumpValue(oss);
+    return oss.str();
+}
+
+// Returns the mean time per call in ns
+template <typename F> static double time_ns(int iterations, F&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        func();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+static bool run(const std::string& label, const pvd::PVField& field, int iterations) {
+    std::string stream_out;
+    const double stream_ns = time_ns(iterations, [&] { stream_out = stream_format(field); });
+
+    std::string fast_out;
+    const double fast_ns = time_ns(iterations, [&] { pvtui::format_value(field, PRECISION, fast_out); });
+
+    std::cout << "  " << label << ": stream " << stream_ns << " ns, to_chars " << fast_ns << " ns, "
+              << stream_ns / fast_ns << "x\n";
+    return fast_out == stream_out;
+}
+
+int main() {
+
+    std::cout << "[pvtui::format_value] formatting benchmark\n";
+
+    auto scalar_type =
+        pvd::getFieldCreate()->createFieldBuilder()->add("value", pvd::pvDouble)->createStructure();
+    auto scalar_root = pvd::getPVDataCreate()->createPVStructure(scalar_type);
+    scalar_root->getSubFieldT<pvd::PVDouble>("value")->put(-1234.56789);
+
+    auto array_type =
+        pvd::getFieldCreate()->createFieldBuilder()->addArray("value", pvd::pvDouble)->createStructure();
+    auto array_root = pvd::getPVDataCreate()->createPVStructure(array_type);
+    pvd::shared_vector<double> samples(NUM_SAMPLES);
+    for (size_t i = 0; i < NUM_SAMPLES; i++) {
+        samples[i] = 0.001 * static_cast<double>(i * i) - 250.0;
+    }
+    array_root->getSubFieldT<pvd::PVDoubleArray>("value")->replace(pvd::freeze(samples));
+
+    bool ok = true;
+    ok &= run("double", *scalar_root->getSubField("value"), NUM_ITERATIONS);
+    ok &= run("double[" + std::to_string(NUM_SAMPLES) + "]", *array_root->getSubField("value"),
+              NUM_ITERATIONS / static_cast<int>(NUM_SAMPLES));
+
+    if (!ok) {
+        std::cout << "[pvtui::format_value] FAILED: output differs from dumpValue" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "[pvtui::format_value] Output matches dumpValue" << std::endl;
+}
@@ -0,0 +1,125 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+
+#include <pv/pvData.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pvtui/pvgroup.hpp>
+
+// Measures the cost of PVGroup::sync() for a large group where only a small
+// fraction of the PVs change between syncs. PVs are served by an in-process
+// pvas::StaticProvider so no IOC or network is required.
+
+namespace pvd = epics::pvData;
+
+constexpr size_t NUM_PVS = 10000;
+constexpr size_t NUM_CHANGED = NUM_PVS / 100; // 1% churn
+constexpr int NUM_ITERATIONS = 100;
+
+struct ServedPV {
+    std::shared_ptr<pvas::SharedPV> pv;
+    pvd::PVStructurePtr root;
+};
+
+static void post_value(ServedPV& served, double value) {
+    auto value_field = served.root->getSubFieldT<pvd::PVDouble>("value");
+    value_field->put(value);
+    pvd::BitSet changed;
+    changed.set(value_field->getFieldOffset());
+    served.pv->post(*served.root, changed);
+}
+
+// Waits for the group to be notified of new data, then gives the
+// remaining callbacks a moment to be delivered
+static void wait_for_updates(pvtui::PVGroup& group) {
+    pollfd fd = {group.notifier().fd(), POLLIN, 0};
+    poll(&fd, 1, 1000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+}
+
+int main() {
+
+    std::cout << "[pvtui::PVGroup] sync benchmark: " << NUM_PVS << " PVs, " << NUM_CHANGED
+              << " changed per sync\n";
+
+    // Serve NUM_PVS double PVs in-process
+    auto type = pvd::getFieldCreate()
+                    ->createFieldBuilder()
+                    ->setId("epics:nt/NTScalar:1.0")
+                    ->add("value", pvd::pvDouble)
+                    ->createStructure();
+
+    pvas::StaticProvider server("bench");
+    std::vector<ServedPV> served(NUM_PVS);
+    std::vector<std::string> names(NUM_PVS);
+    for (size_t i = 0; i < NUM_PVS; i++) {
+        names[i] = "bench:pv" + std::to_string(i);
+        served[i].pv = pvas::SharedPV::buildReadOnly();
+        served[i].root = pvd::getPVDataCreate()->createPVStructure(type);
+        served[i].pv->open(*served[i].root);
+        server.add(names[i], served[i].pv);
+    }
+
+    // Monitor all of them from a single group
+    pvac::ClientProvider provider(server.provider());
+    pvtui::PVGroup group(provider);
+    std::vector<double> values(NUM_PVS, 0.0);
+    std::vector<pvtui::PVHandler*> handlers(NUM_PVS);
+    for (size_t i = 0; i < NUM_PVS; i++) {
+        group.add(names[i]);
+        group.set_monitor(names[i], values[i]);
+        handlers[i] = &group.get_pv(names[i]);
+    }
+
+    // Post once to every PV and drain so all monitors are in a steady state
+    for (size_t i = 0; i < NUM_PVS; i++) {
+        post_value(served[i], 0.0);
+    }
+    wait_for_updates(group);
+    group.notifier().clear();
+    group.sync();
+
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<size_t> pick(0, NUM_PVS - 1);
+    auto post_churn = [&](int iteration) {
+        for (size_t n = 0; n < NUM_CHANGED; n++) {
+            post_value(served[pick(rng)], iteration + 1.0);
+        }
+        wait_for_updates(group);
+        group.notifier().clear();
+    };
+
+    using clock = std::chrono::steady_clock;
+    clock::duration dirty_total{0};
+    clock::duration scan_total{0};
+    for (int it = 0; it < NUM_ITERATIONS; it++) {
+        // PVGroup::sync only visits handlers in the dirty queue
+        post_churn(it);
+        auto start = clock::now();
+        group.sync();
+        dirty_total += clock::now() - start;
+
+        // Reference: visit every handler like a full scan of the group
+        post_churn(it);
+        start = clock::now();
+        for (auto* pv : handlers) {
+            pv->sync();
+        }
+        scan_total += clock::now() - start;
+        group.sync(); // discard the queue entries the scan already handled
+    }
+
+    auto avg_us = [](clock::duration d) {
+        return std::chrono::duration<double, std::micro>(d).count() / NUM_ITERATIONS;
+    };
+    std::cout << "  dirty-queue sync: " << avg_us(dirty_total) << " us/sync\n";
+    std::cout << "  full-scan sync:   " << avg_us(scan_total) << " us/sync\n";
+    std::cout << "[pvtui::PVGroup] benchmark done" << std::endl;
+}
@@ -0,0 +1,320 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+
+#include <ftxui/dom/elements.hpp>
+#include <ftxui/dom/node.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <pv/pvData.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pvtui/pvgroup.hpp>
+#include <pvtui/pvtui.hpp>
+
+#include "../apps/motor_display.hpp"
+
+// Microbenchmarks for the decode, sync, and render hot paths. Everything is served
+// by an in-process pvas::StaticProvider, so no IOC or network is required.
+//
+// Usage: pvtui_bench [iterations multiplier]
+
+namespace pvd = epics::pvData;
+using clock_type = std::chrono::steady_clock;
+
+constexpr size_t ARRAY_SIZE = 1000;
+constexpr size_t NUM_STRINGS = 64;
+constexpr size_t NUM_CHOICES = 16;
+
+static int g_scale = 1;
+
+static void report(const std::string& label, clock_type::duration elapsed, size_t ops) {
+    const double ns = std::chrono::duration<double, std::nano>(elapsed).count() / ops;
+    std::cout << "  " << std::left << std::setw(32) << label << std::right << std::setw(12) << std::fixed
+              << std::setprecision(1) << ns << " ns/op\n";
+}
+
+// ---------------------------------------------------------------------------
+// Structures for every MonitorVar alternative
+// ---------------------------------------------------------------------------
+
+enum class Kind { Double, Int, String, Enum, DoubleArray, IntArray, StringArray };
+
+static pvd::StructureConstPtr make_type(Kind kind) {
+    auto builder = pvd::getFieldCreate()->createFieldBuilder();
+    switch (kind) {
+    case Kind::Double:
+        return builder->setId("epics:nt/NTScalar:1.0")->add("value", pvd::pvDouble)->createStructure();
+    case Kind::Int:
+        return builder->setId("epics:nt/NTScalar:1.0")->add("value", pvd::pvInt)->createStructure();
+    case Kind::String:
+        return builder->setId("epics:nt/NTScalar:1.0")->add("value", pvd::pvString)->createStructure();
+    case Kind::Enum:
+        return builder->setId("epics:nt/NTEnum:1.0")
+            ->addNestedStructure("value")
+            ->setId("enum_t")
+            ->add("index", pvd::pvInt)
+            ->addArray("choices", pvd::pvString)
+            ->endNested()
+            ->createStructure();
+    case Kind::DoubleArray:
+        return builder->setId("epics:nt/NTScalarArray:1.0")->addArray("value", pvd::pvDouble)->createStructure();
+    case Kind::IntArray:
+        return builder->setId("epics:nt/NTScalarArray:1.0")->addArray("value", pvd::pvInt)->createStructure();
+    case Kind::StringArray:
+        return builder->setId("epics:nt/NTScalarArray:1.0")->addArray("value", pvd::pvString)->createStructure();
+    }
+    return nullptr;
+}
+
+static pvd::shared_vector<const std::string> make_strings(size_t n) {
+    pvd::shared_vector<std::string> strings(n);
+    for (size_t i = 0; i < n; i++) {
+        strings[i] = "choice " + std::to_string(i);
+    }
+    return pvd::freeze(strings);
+}
+
+// Creates a value of the given kind with every field filled in
+static pvd::PVStructurePtr make_value(Kind kind) {
+    auto root = pvd::getPVDataCreate()->createPVStructure(make_type(kind));
+    switch (kind) {
+    case Kind::Double:
+        root->getSubFieldT<pvd::PVDouble>("value")->put(1.2345);
+        break;
+    case Kind::Int:
+        root->getSubFieldT<pvd::PVInt>("value")->put(12345);
+        break;
+    case Kind::String:
+        root->getSubFieldT<pvd::PVString>("value")->put("motor description");
+        break;
+    case Kind::Enum:
+        root->getSubFieldT<pvd::PVInt>("value.index")->put(1);
+        root->getSubFieldT<pvd::PVStringArray>("value.choices")->replace(make_strings(NUM_CHOICES));
+        break;
+    case Kind::DoubleArray: {
+        pvd::shared_vector<double> vals(ARRAY_SIZE);
+        for (size_t i = 0; i < ARRAY_SIZE; i++) {
+            vals[i] = 0.5 * i;
+        }
+        root->getSubFieldT<pvd::PVDoubleArray>("value")->replace(pvd::freeze(vals));
+        break;
+    }
+    case Kind::IntArray: {
+        pvd::shared_vector<pvd::int32> vals(ARRAY_SIZE);
+        for (size_t i = 0; i < ARRAY_SIZE; i++) {
+            vals[i] = static_cast<pvd::int32>(i);
+        }
+        root->getSubFieldT<pvd::PVIntArray>("value")->replace(pvd::freeze(vals));
+        break;
+    }
+    case Kind::StringArray:
+        root->getSubFieldT<pvd::PVStringArray>("value")->replace(make_strings(NUM_STRINGS));
+        break;
+    }
+    return root;
+}
+
+// ---------------------------------------------------------------------------
+// Decode: PVHandler::process_update() followed by sync() for each MonitorVar type
+// ---------------------------------------------------------------------------
+
+template <typename T>
+static void bench_decode(pvac::ClientProvider& provider, const std::string& label, Kind kind) {
+    const int iterations = 20000 * g_scale;
+    auto root = make_value(kind);
+    pvd::BitSet changed;
+    changed.set(root->getSubField("value")->getFieldOffset());
+
+    pvtui::PVHandler pv(provider, "bench:decode:" + label);
+    T var{};
+    pv.set_monitor(var);
+
+    for (int i = 0; i < 100; i++) {
+        pv.process_update(*root, changed);
+        pv.sync();
+    }
+
+    const auto start = clock_type::now();
+    for (int i = 0; i < iterations; i++) {
+        pv.process_update(*root, changed);
+        pv.sync();
+    }
+    report(label, clock_type::now() - start, iterations);
+}
+
+// ---------------------------------------------------------------------------
+// Served PVs for the sync and render benchmarks
+// ---------------------------------------------------------------------------
+
+struct ServedPV {
+    std::shared_ptr<pvas::SharedPV> pv;
+    pvd::PVStructurePtr root;
+};
+
+static ServedPV serve(pvas::StaticProvider& server, const std::string& name, Kind kind) {
+    ServedPV served{pvas::SharedPV::buildReadOnly(), make_value(kind)};
+    served.pv->open(*served.root);
+    server.add(name, served.pv);
+    return served;
+}
+
+static bool wait_connected(pvtui::PVGroup& group, const std::vector<std::string>& names) {
+    const auto deadline = clock_type::now() + std::chrono::seconds(10);
+    for (const auto& name : names) {
+        while (!group.get_pv(name).connected()) {
+            if (clock_type::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// PVGroup::sync() with every PV in the group changed
+// ---------------------------------------------------------------------------
+
+static void bench_sync(pvas::StaticProvider& server, pvac::ClientProvider& provider, size_t size) {
+    const int iterations = 20 * g_scale;
+    const std::string prefix = "bench:sync" + std::to_string(size) + ":";
+
+    std::vector<ServedPV> served;
+    std::vector<std::string> names;
+    for (size_t i = 0; i < size; i++) {
+        names.push_back(prefix + std::to_string(i));
+        served.push_back(serve(server, names.back(), Kind::Double));
+    }
+
+    pvtui::PVGroup group(provider, names);
+    std::vector<double> values(size, 0.0);
+    for (size_t i = 0; i < size; i++) {
+        group.set_monitor(names[i], values[i]);
+    }
+    if (!wait_connected(group, names)) {
+        std::cout << "  sync " << size << " PVs: timed out connecting\n";
+        return;
+    }
+
+    clock_type::duration total{0};
+    for (int it = 0; it < iterations; it++) {
+        for (auto& pv : served) {
+            auto value = pv.root->getSubFieldT<pvd::PVDouble>("value");
+            value->put(it + 1.0);
+            pvd::BitSet changed;
+            changed.set(value->getFieldOffset());
+            pv.pv->post(*pv.root, changed);
+        }
+
+        // Wait for the last PV, then give the remaining callbacks a moment
+        const auto deadline = clock_type::now() + std::chrono::seconds(1);
+        while (group.get_pv(names.back()).counters().received < static_cast<uint64_t>(it) + 2 &&
+               clock_type::now() < deadline) {
+            pollfd fd = {group.notifier().fd(), POLLIN, 0};
+            poll(&fd, 1, 10);
+            group.notifier().clear();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+        const auto start = clock_type::now();
+        group.sync();
+        total += clock_type::now() - start;
+    }
+    report("sync " + std::to_string(size) + " PVs", total, iterations);
+}
+
+// ---------------------------------------------------------------------------
+// Full frame render of the motor displays
+// ---------------------------------------------------------------------------
+
+static std::vector<ServedPV> serve_motor(pvas::StaticProvider& server, const std::string& motor) {
+    const std::vector<std::pair<std::string, Kind>> fields = {
+        {".DESC", Kind::String}, {".EGU", Kind::String},  {".DMOV", Kind::Int},    {".HLS", Kind::Int},
+        {".LLS", Kind::Int},     {".LVIO", Kind::Int},    {".PREC", Kind::Int},    {".RTRY", Kind::Int},
+        {".RVAL", Kind::Int},    {".RRBV", Kind::Int},    {".CNEN", Kind::Enum},   {".DIR", Kind::Enum},
+        {".SET", Kind::Enum},    {".SPMG", Kind::Enum},   {".UEIP", Kind::Enum},   {".URIP", Kind::Enum},
+        {".FOFF", Kind::Enum},   {"_able", Kind::Enum},   {".ACCL", Kind::Double}, {".DHLM", Kind::Double},
+        {".DLLM", Kind::Double}, {".DRBV", Kind::Double}, {".DVAL", Kind::Double}, {".ERES", Kind::Double},
+        {".HLM", Kind::Double},  {".LLM", Kind::Double},  {".MRES", Kind::Double}, {".OFF", Kind::Double},
+        {".RBV", Kind::Double},  {".RLV", Kind::Double},  {".RRES", Kind::Double}, {".STOP", Kind::Int},
+        {".TWF", Kind::Int},     {".TWR", Kind::Int},     {".TWV", Kind::Double},  {".VAL", Kind::Double},
+        {".VBAS", Kind::Double}, {".VELO", Kind::Double}, {".VMAX", Kind::Double},
+    };
+    std::vector<ServedPV> served;
+    for (const auto& [field, kind] : fields) {
+        served.push_back(serve(server, motor + field, kind));
+    }
+    return served;
+}
+
+template <typename Display>
+static void bench_render(pvac::ClientProvider& provider, const pvtui::ArgParser& args, const std::string& label) {
+    const int iterations = 500 * g_scale;
+    pvtui::PVGroup group(provider);
+    Display display(group, args);
+
+    // Give the channels a moment to connect and deliver their first value
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    group.sync();
+
+    auto screen = ftxui::Screen::Create(ftxui::Dimension::Fixed(120), ftxui::Dimension::Fixed(50));
+    auto start = clock_type::now();
+    for (int i = 0; i < iterations; i++) {
+        ftxui::Render(screen, display.get_renderer());
+    }
+    report(label, clock_type::now() - start, iterations);
+
+    // Nothing changes between frames, so render() reuses the cached element
+    start = clock_type::now();
+    for (int i = 0; i < iterations; i++) {
+        ftxui::Render(screen, display.render());
+    }
+    report(label + " (cached)", clock_type::now() - start, iterations);
+}
+
+int main(int argc, char* argv[]) {
+
+    if (argc > 1) {
+        g_scale = std::max(1, std::atoi(argv[1]));
+    }
+
+    pvas::StaticProvider server("bench");
+    pvac::ClientProvider provider(server.provider());
+
+    std::cout << "[pvtui_bench] decode + sync, per update\n";
+    bench_decode<std::string>(provider, "string", Kind::String);
+    bench_decode<int>(provider, "int", Kind::Int);
+    bench_decode<double>(provider, "double", Kind::Double);
+    bench_decode<std::vector<std::string>>(provider, "vector<string>", Kind::StringArray);
+    bench_decode<std::vector<int>>(provider, "vector<int>", Kind::IntArray);
+    bench_decode<std::vector<double>>(provider, "vector<double>", Kind::DoubleArray);
+    bench_decode<pvtui::PVEnum>(provider, "PVEnum", Kind::Enum);
+    bench_decode<pvtui::SharedArray<double>>(provider, "SharedArray<double>", Kind::DoubleArray);
+    bench_decode<pvtui::SharedArray<int>>(provider, "SharedArray<int>", Kind::IntArray);
+
+    std::cout << "[pvtui_bench] PVGroup::sync, all PVs changed\n";
+    for (size_t size : {10, 100, 1000, 10000}) {
+        bench_sync(server, provider, size);
+    }
+
+    std::cout << "[pvtui_bench] motor display render, 120x50\n";
+    auto motor = serve_motor(server, "bench:m1");
+    char arg0[] = "pvtui_bench";
+    char arg1[] = "--macro";
+    char arg2[] = "P=bench:,M=m1";
+    char* args_argv[] = {arg0, arg1, arg2, nullptr};
+    pvtui::ArgParser args(3, args_argv);
+    bench_render<SmallMotorDisplay>(provider, args, "SmallMotorDisplay");
+    bench_render<MediumMotorDisplay>(provider, args, "MediumMotorDisplay");
+    bench_render<AllMotorDisplay>(provider, args, "AllMotorDisplay");
+
+    std::cout << "[pvtui_bench] done" << std::endl;
+}
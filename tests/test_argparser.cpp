@@ -65,6 +65,30 @@ int main() {
 	assert(parser.macros.size() == 0);
     }
 
+    {
+	char arg0[] = "ArgParser test";
+	char arg1[] = "--headless";
+	char arg2[] = "--format";
+	char arg3[] = "jsonl";
+	char arg4[] = "--max-rate";
+	char arg5[] = "2.5";
+	char *args[] = {arg0, arg1, arg2, arg3, arg4, arg5, nullptr};
+	pvtui::ArgParser parser(6, args);
+	assert(parser.headless);
+	assert(parser.format == "jsonl");
+	assert(parser.output.empty());
+	assert(parser.max_rate == 2.5);
+    }
+
+    {
+	char arg0[] = "ArgParser test";
+	char *args[] = {arg0, nullptr};
+	pvtui::ArgParser parser(1, args);
+	assert(!parser.headless);
+	assert(parser.format == "csv");
+	assert(parser.max_rate == 0.0);
+    }
+
     std::cout << "[pvtui::ArgParser] All tests passed" << std::endl;
 
 }
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pv/pvData.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pvtui/pvgroup.hpp>
+
+// Connects a group of in-process PVs with a small ConnectScheduler limit and checks
+// that no more than the limit are connecting at once, that a prioritized channel is
+// opened first, and that every channel is eventually opened, connected, and delivers its
+// value. Channels which are never served hold the connecting slots until they time out.
+
+namespace pvd = epics::pvData;
+
+constexpr size_t NUM_PVS = 50;
+constexpr size_t LIMIT = 4;
+
+int main() {
+
+    std::cout << "[pvtui::ConnectScheduler] Running tests...\n";
+
+    auto type = pvd::getFieldCreate()
+                    ->createFieldBuilder()
+                    ->setId("epics:nt/NTScalar:1.0")
+                    ->add("value", pvd::pvDouble)
+                    ->createStructure();
+
+    pvas::StaticProvider server("test");
+    std::vector<std::shared_ptr<pvas::SharedPV>> served(NUM_PVS);
+    std::vector<std::string> names(NUM_PVS);
+    for (size_t i = 0; i < NUM_PVS; i++) {
+        names[i] = "test:pv" + std::to_string(i);
+        auto root = pvd::getPVDataCreate()->createPVStructure(type);
+        root->getSubFieldT<pvd::PVDouble>("value")->put(static_cast<double>(i));
+        served[i] = pvas::SharedPV::buildReadOnly();
+        served[i]->open(*root);
+        server.add(names[i], served[i]);
+    }
+
+    pvtui::ConnectScheduler::set_limit(LIMIT);
+    assert(pvtui::ConnectScheduler::limit() == LIMIT);
+
+    std::mutex mutex;
+    std::vector<std::string> order;
+    size_t max_connecting = 0;
+    pvtui::ConnectScheduler::set_open_hook([&](const std::string& name) {
+        const pvtui::ConnectStats now = pvtui::ConnectScheduler::stats();
+        const std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(name);
+        max_connecting = std::max(max_connecting, now.connecting);
+    });
+    auto opened = [&] {
+        const std::lock_guard<std::mutex> lock(mutex);
+        return order.size();
+    };
+
+    pvac::ClientProvider provider(server.provider());
+    auto missing = std::make_unique<pvtui::PVGroup>(provider);
+    for (size_t i = 0; i < LIMIT; i++) {
+        missing->add("test:missing" + std::to_string(i));
+    }
+    for (int i = 0; i < 100 && opened() < LIMIT; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    assert(opened() == LIMIT);
+
+    pvtui::PVGroup group(provider);
+    std::vector<double> values(NUM_PVS, -1.0);
+    for (size_t i = 0; i < NUM_PVS; i++) {
+        group.add(names[i]);
+        group.set_monitor(names[i], values[i]);
+    }
+
+    // The last PV is drawn first, so it skips the queue
+    group[names.back()].prioritize();
+
+    pvtui::ConnectStats stats = pvtui::ConnectScheduler::stats();
+    assert(stats.channels == NUM_PVS + LIMIT);
+    assert(stats.queued == NUM_PVS);
+    for (int i = 0; i < 500 && stats.connected < NUM_PVS; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        stats = pvtui::ConnectScheduler::stats();
+    }
+    assert(stats.connected == NUM_PVS);
+    assert(stats.queued == 0);
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        assert(order.size() == NUM_PVS + LIMIT);
+        assert(order[LIMIT] == names.back());
+        assert(max_connecting <= LIMIT);
+    }
+    assert(stats.peak_connecting == LIMIT);
+    std::cout << "  At most " << LIMIT << " connecting, the prioritized channel opened first\n";
+
+    // The missing channels keep the batch from completing, and are reported
+    for (int i = 0; i < 100 && stats.timed_out < LIMIT; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        stats = pvtui::ConnectScheduler::stats();
+    }
+    assert(stats.timed_out == LIMIT);
+    assert(stats.all_connected_ms < 0.0);
+    missing.reset();
+    stats = pvtui::ConnectScheduler::stats();
+    assert(stats.timed_out == 0);
+    assert(stats.channels == NUM_PVS);
+    assert(stats.all_connected_ms >= 0.0);
+    std::cout << "  " << NUM_PVS << " channels, " << LIMIT << " missing: all connected in "
+              << stats.all_connected_ms << " ms\n";
+    pvtui::ConnectScheduler::set_open_hook(nullptr);
+
+    auto all_received = [&values] {
+        return std::all_of(values.begin(), values.end(), [](double v) { return v >= 0.0; });
+    };
+    for (int i = 0; i < 100 && !all_received(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        group.sync();
+    }
+    group.for_each([](pvtui::PVHandler& pv) { assert(pv.connected()); });
+    for (size_t i = 0; i < NUM_PVS; i++) {
+        assert(values[i] == static_cast<double>(i));
+    }
+
+    std::cout << "[pvtui::ConnectScheduler] All tests passed" << std::endl;
+}
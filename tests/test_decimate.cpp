@@ -0,0 +1,91 @@
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <pvtui/decimate.hpp>
+
+// Compares minmax_decimate against a plain loop, including spikes, NaN, and waveforms
+// shorter than the number of columns, and times it on a 100k sample trace.
+
+static void check_against_naive(const std::vector<double>& data, size_t columns) {
+    pvtui::WaveformEnvelope env;
+    pvtui::minmax_decimate(data.data(), data.size(), columns, env);
+    assert(env.size() == columns);
+    for (size_t i = 0; i < columns; i++) {
+        size_t start = std::min(i * data.size() / columns, data.size() - 1);
+        size_t end = std::max((i + 1) * data.size() / columns, start + 1);
+        double mn = std::numeric_limits<double>::infinity();
+        double mx = -mn;
+        for (size_t j = start; j < end; j++) {
+            if (!std::isnan(data[j])) {
+                mn = std::min(mn, data[j]);
+                mx = std::max(mx, data[j]);
+            }
+        }
+        assert(env.min[i] == mn);
+        assert(env.max[i] == mx);
+    }
+}
+
+int main() {
+
+    std::cout << "[pvtui::minmax_decimate] Running tests...\n";
+
+    std::vector<double> wave(1000);
+    for (size_t i = 0; i < wave.size(); i++) {
+        wave[i] = std::sin(i * 0.01) + (i % 7) * 0.001;
+    }
+    for (size_t columns : {1, 3, 100, 333, 999, 1000}) {
+        check_against_naive(wave, columns);
+    }
+
+    // A single sample spike survives decimation
+    std::vector<double> flat(10000, 1.0);
+    flat[4321] = 50.0;
+    flat[9999] = -50.0;
+    pvtui::WaveformEnvelope env;
+    pvtui::minmax_decimate(flat.data(), flat.size(), 100, env);
+    assert(env.max[43] == 50.0);
+    assert(env.min[99] == -50.0);
+    assert(env.min[43] == 1.0 && env.max[42] == 1.0);
+
+    // NaN samples are skipped, a column of only NaN has min > max
+    std::vector<double> gaps(64, 2.0);
+    for (size_t i = 0; i < 16; i++) {
+        gaps[i] = std::numeric_limits<double>::quiet_NaN();
+    }
+    gaps[20] = std::numeric_limits<double>::quiet_NaN();
+    gaps[21] = -3.0;
+    check_against_naive(gaps, 4);
+    pvtui::minmax_decimate(gaps.data(), gaps.size(), 4, env);
+    assert(!(env.min[0] <= env.max[0]));
+    assert(env.min[1] == -3.0 && env.max[1] == 2.0);
+
+    // Fewer samples than columns repeats samples, no samples leaves every column empty
+    std::vector<double> few = {1.0, 2.0, 3.0};
+    check_against_naive(few, 8);
+    pvtui::minmax_decimate(few.data(), 0, 8, env);
+    for (size_t i = 0; i < env.size(); i++) {
+        assert(!(env.min[i] <= env.max[i]));
+    }
+
+    // 100k sample scope trace reduced to a wide terminal
+    constexpr int NUM_ITERATIONS = 200;
+    std::vector<double> trace(100000);
+    for (size_t i = 0; i < trace.size(); i++) {
+        trace[i] = std::sin(i * 0.001) * 100.0;
+    }
+    check_against_naive(trace, 400);
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < NUM_ITERATIONS; i++) {
+        pvtui::minmax_decimate(trace.data(), trace.size(), 400, env);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "  100000 samples to 400 columns: "
+              << std::chrono::duration<double, std::micro>(elapsed).count() / NUM_ITERATIONS << " us\n";
+
+    std::cout << "[pvtui::minmax_decimate] All tests passed" << std::endl;
+}
@@ -0,0 +1,71 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include <pvtui/decode_pool.hpp>
+
+// Checks that every task submitted to a DecodePool runs exactly once, including tasks
+// submitted by workers, and that idle workers steal from a busy one.
+
+int main() {
+
+    std::cout << "[pvtui::DecodePool] Running tests...\n";
+
+    {
+        pvtui::DecodePool pool(4);
+        assert(pool.size() == 4);
+        std::atomic<int> ran{0};
+        for (int i = 0; i < 10000; i++) {
+            pool.submit([&ran] { ran.fetch_add(1, std::memory_order_relaxed); });
+        }
+        pool.wait_idle();
+        assert(ran.load() == 10000);
+        std::cout << "[pvtui::DecodePool] Tasks run exactly once\n";
+
+        // Tasks queued by a worker go to its own queue, where the others steal them
+        ran = 0;
+        std::mutex mutex;
+        std::set<std::thread::id> threads;
+        pool.submit([&] {
+            for (int i = 0; i < 64; i++) {
+                pool.submit([&] {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    {
+                        const std::lock_guard<std::mutex> lock(mutex);
+                        threads.insert(std::this_thread::get_id());
+                    }
+                    ran.fetch_add(1, std::memory_order_relaxed);
+                });
+            }
+        });
+        pool.wait_idle();
+        assert(ran.load() == 64);
+        assert(threads.size() > 1);
+        std::cout << "[pvtui::DecodePool] Idle workers steal nested tasks\n";
+    }
+
+    {
+        // The destructor runs what is still queued
+        std::atomic<int> ran{0};
+        {
+            pvtui::DecodePool pool(2);
+            for (int i = 0; i < 100; i++) {
+                pool.submit([&ran] { ran.fetch_add(1, std::memory_order_relaxed); });
+            }
+        }
+        assert(ran.load() == 100);
+        std::cout << "[pvtui::DecodePool] Destructor drains the queues\n";
+    }
+
+    {
+        pvtui::DecodePool pool;
+        assert(pool.size() >= 1);
+        pool.wait_idle(); // returns right away with nothing queued
+    }
+
+    std::cout << "[pvtui::DecodePool] All tests passed!" << std::endl;
+}
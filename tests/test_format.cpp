@@ -0,0 +1,130 @@
+#include <cassert>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <pv/pvData.h>
+#include <pvtui/pvgroup.hpp>
+
+namespace pvd = epics::pvData;
+
+static pvd::PVStructurePtr make_root(pvd::ScalarType type, bool array) {
+    auto builder = pvd::getFieldCreate()->createFieldBuilder();
+    builder = array ? builder->addArray("value", type) : builder->add("value", type);
+    return pvd::getPVDataCreate()->createPVStructure(builder->createStructure());
+}
+
+// format_value must produce exactly what the stream path it replaces does
+static void check_matches_stream(const pvd::PVField& field, int precision) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(precision);
+    field.dumpValue(oss);
+    std::string out = "stale";
+    assert(pvtui::format_value(field, precision, out));
+    assert(out == oss.str());
+}
+
+int main() {
+
+    std::cout << "[pvtui::parse_format_precision] Running tests...\n";
+
+    assert(pvtui::parse_format_precision("F8.3") == 3);
+    assert(pvtui::parse_format_precision("F10.0") == 0);
+    assert(pvtui::parse_format_precision("F1.12") == 12);
+
+    // Anything not matching F<width>.<precision> exactly is rejected
+    assert(!pvtui::parse_format_precision(""));
+    assert(!pvtui::parse_format_precision("F"));
+    assert(!pvtui::parse_format_precision("F8"));
+    assert(!pvtui::parse_format_precision("F8."));
+    assert(!pvtui::parse_format_precision("F.3"));
+    assert(!pvtui::parse_format_precision("E8.3"));
+    assert(!pvtui::parse_format_precision("F8.3f"));
+    assert(!pvtui::parse_format_precision("F8.-3"));
+    assert(!pvtui::parse_format_precision(" F8.3"));
+    assert(!pvtui::parse_format_precision("F8.99999999999"));
+
+    std::cout << "[pvtui::parse_format_precision] All tests passed" << std::endl;
+
+    std::cout << "[pvtui::format_value] Running tests...\n";
+
+    const std::vector<pvd::ScalarType> numeric = {pvd::pvByte,  pvd::pvShort,  pvd::pvInt,  pvd::pvLong,
+                                                  pvd::pvUByte, pvd::pvUShort, pvd::pvUInt, pvd::pvULong,
+                                                  pvd::pvFloat, pvd::pvDouble};
+    // Values every type can hold
+    const std::vector<double> values = {0.0, 1.0, 42.5, 127.0};
+    const std::vector<double> signed_values = {-3.25, -128.0};
+    const std::vector<int> precisions = {0, 3, 8, -1};
+
+    for (pvd::ScalarType type : numeric) {
+        const bool is_signed = !pvd::ScalarTypeFunc::isUInteger(type);
+        std::vector<double> all = values;
+        if (is_signed) {
+            all.insert(all.end(), signed_values.begin(), signed_values.end());
+        }
+
+        auto root = make_root(type, false);
+        auto scalar = root->getSubFieldT<pvd::PVScalar>("value");
+        for (double v : all) {
+            scalar->putFrom(v);
+            for (int precision : precisions) {
+                check_matches_stream(*scalar, precision);
+            }
+        }
+
+        auto array_root = make_root(type, true);
+        auto array = array_root->getSubFieldT<pvd::PVScalarArray>("value");
+        pvd::shared_vector<double> samples(all.size());
+        std::copy(all.begin(), all.end(), samples.begin());
+        array->putFrom(pvd::freeze(samples));
+        for (int precision : precisions) {
+            check_matches_stream(*array, precision);
+        }
+        array->putFrom(pvd::shared_vector<const double>());
+        check_matches_stream(*array, 3); // empty array
+    }
+    std::cout << "[pvtui::format_value] Scalars and arrays of every numeric type match dumpValue\n";
+
+    // Limits of the 64 bit integers, and the floating point special values
+    auto long_root = make_root(pvd::pvLong, false);
+    long_root->getSubFieldT<pvd::PVScalar>("value")->putFrom(std::numeric_limits<pvd::int64>::min());
+    check_matches_stream(*long_root->getSubField("value"), 3);
+    auto ulong_root = make_root(pvd::pvULong, false);
+    ulong_root->getSubFieldT<pvd::PVScalar>("value")->putFrom(std::numeric_limits<pvd::uint64>::max());
+    check_matches_stream(*ulong_root->getSubField("value"), 3);
+
+    const std::vector<double> special = {std::nan(""), -std::nan(""), std::numeric_limits<double>::infinity(),
+                                         -std::numeric_limits<double>::infinity(), -0.0, -0.0001, 0.5, 2.5,
+                                         123456.789, 1e15};
+    for (pvd::ScalarType type : {pvd::pvFloat, pvd::pvDouble}) {
+        auto root = make_root(type, false);
+        auto scalar = root->getSubFieldT<pvd::PVScalar>("value");
+        for (double v : special) {
+            scalar->putFrom(v);
+            for (int precision : precisions) {
+                check_matches_stream(*scalar, precision);
+            }
+        }
+    }
+    std::cout << "[pvtui::format_value] Limits, NaN, infinity, and rounding match dumpValue\n";
+
+    // Numbers too long for the buffer are left to the stream
+    auto big_root = make_root(pvd::pvDouble, false);
+    big_root->getSubFieldT<pvd::PVScalar>("value")->putFrom(1e300);
+    std::string big;
+    assert(!pvtui::format_value(*big_root->getSubField("value"), 3, big));
+
+    // Strings, booleans, and structures keep dumpValue's own formatting
+    std::string out;
+    assert(!pvtui::format_value(*make_root(pvd::pvString, false)->getSubField("value"), 3, out));
+    assert(!pvtui::format_value(*make_root(pvd::pvBoolean, false)->getSubField("value"), 3, out));
+    assert(!pvtui::format_value(*make_root(pvd::pvBoolean, true)->getSubField("value"), 3, out));
+    assert(!pvtui::format_value(*make_root(pvd::pvDouble, false), 3, out));
+    std::cout << "[pvtui::format_value] Non-numeric fields are rejected\n";
+
+    std::cout << "[pvtui::format_value] All tests passed" << std::endl;
+}
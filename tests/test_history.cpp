@@ -0,0 +1,100 @@
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+#include <pvtui/history.hpp>
+
+// Checks the ring buffer and the time columns of SampleHistory, and that extending the
+// history by one sample doesn't make drawing a frame slower.
+
+static bool empty_column(const pvtui::WaveformEnvelope& env, size_t x) { return !(env.min[x] <= env.max[x]); }
+
+int main() {
+
+    std::cout << "[pvtui::SampleHistory] Running tests...\n";
+
+    {
+        // Oldest samples are overwritten once full
+        pvtui::SampleHistory history(4);
+        assert(history.size() == 0);
+        assert(!history.newest());
+        for (int i = 0; i < 6; i++) {
+            history.push(100.0 + i, i);
+        }
+        assert(history.size() == 4);
+        assert(history.capacity() == 4);
+        auto samples = history.samples();
+        assert(samples.size() == 4);
+        assert(samples.front().value == 2.0 && samples.back().value == 5.0);
+        assert(history.newest()->time == 105.0);
+    }
+
+    {
+        pvtui::SampleHistory history(100);
+        pvtui::WaveformEnvelope env;
+
+        // Nothing recorded yet: every column is empty
+        history.envelope(110.0, 10, 1.0, env);
+        assert(env.size() == 10);
+        for (size_t x = 0; x < env.size(); x++) {
+            assert(empty_column(env, x));
+        }
+
+        // Columns are [101, 102), ..., [110, 111)
+        history.push(95.0, 7.0);  // left of the window, held into it
+        history.push(103.2, 1.0);
+        history.push(103.7, 4.0);
+        history.push(103.9, 2.0);
+        history.push(108.5, -1.0);
+        history.envelope(110.0, 10, 1.0, env);
+        assert(env.min[0] == 7.0 && env.max[0] == 7.0);
+        assert(env.min[1] == 7.0);
+        assert(env.min[2] == 1.0 && env.max[2] == 4.0);
+        assert(env.min[3] == 2.0 && env.max[3] == 2.0); // holds the last value, not the max
+        assert(env.min[7] == -1.0 && env.max[7] == -1.0);
+        assert(env.min[9] == -1.0);
+
+        // Samples pushed after the columns were built are appended to them
+        history.push(110.1, 3.0);
+        history.push(110.2, 5.0);
+        history.push(109.0, 9.0); // out of order, counted in the newest column
+        history.envelope(110.0, 10, 1.0, env);
+        assert(env.min[9] == 3.0 && env.max[9] == 9.0);
+
+        // Scrolling drops old columns
+        history.envelope(115.0, 10, 1.0, env);
+        assert(env.min[2] == -1.0 && env.max[2] == -1.0); // [108, 109)
+        assert(env.min[4] == 3.0 && env.max[4] == 9.0);   // [110, 111)
+        assert(env.min[9] == 9.0 && env.max[9] == 9.0);
+
+        // Changing the column duration rebuilds the columns from the samples
+        history.envelope(109.0, 2, 10.0, env);
+        assert(env.min[0] == 7.0 && env.max[0] == 7.0);  // [90, 100)
+        assert(env.min[1] == -1.0 && env.max[1] == 4.0); // [100, 110)
+    }
+
+    {
+        // A long history costs the same per frame as a short one once it is decimated
+        constexpr size_t NUM_SAMPLES = 1 << 20;
+        constexpr int NUM_FRAMES = 1000;
+        pvtui::SampleHistory history(NUM_SAMPLES);
+        pvtui::WaveformEnvelope env;
+        for (size_t i = 0; i < NUM_SAMPLES; i++) {
+            history.push(i * 0.01, static_cast<double>(i % 100));
+        }
+        history.envelope(NUM_SAMPLES * 0.01, 400, 1.0, env);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < NUM_FRAMES; i++) {
+            history.push((NUM_SAMPLES + i) * 0.01, 1.0);
+            history.envelope((NUM_SAMPLES + i) * 0.01, 400, 1.0, env);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "  " << NUM_SAMPLES << " samples to 400 columns: "
+                  << std::chrono::duration<double, std::micro>(elapsed).count() / NUM_FRAMES << " us/frame\n";
+        assert(env.min[300] == 0.0 && env.max[300] == 99.0);
+        assert(env.min[399] == 1.0 && env.max[399] == 1.0);
+    }
+
+    std::cout << "[pvtui::SampleHistory] All tests passed" << std::endl;
+}
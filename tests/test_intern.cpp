@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <pv/pvData.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pvtui/pvgroup.hpp>
+
+// Checks that equal choice lists and PV names share one copy, that the pool forgets
+// them once unused, and that enum updates keep the shared list when the choices repeat.
+
+namespace pvd = epics::pvData;
+
+static pvd::PVStructurePtr make_enum(const std::vector<std::string>& choices, int index) {
+    auto type = pvd::getFieldCreate()
+                    ->createFieldBuilder()
+                    ->setId("epics:nt/NTEnum:1.0")
+                    ->addNestedStructure("value")
+                    ->setId("enum_t")
+                    ->add("index", pvd::pvInt)
+                    ->addArray("choices", pvd::pvString)
+                    ->endNested()
+                    ->createStructure();
+    auto root = pvd::getPVDataCreate()->createPVStructure(type);
+    root->getSubFieldT<pvd::PVInt>("value.index")->put(index);
+    pvd::shared_vector<std::string> vals(choices.size());
+    std::copy(choices.begin(), choices.end(), vals.begin());
+    root->getSubFieldT<pvd::PVStringArray>("value.choices")->replace(pvd::freeze(vals));
+    return root;
+}
+
+int main() {
+
+    std::cout << "[pvtui::intern] Running tests...\n";
+
+    const std::vector<std::string> on_off = {"Off", "On"};
+    const std::vector<std::string> modes = {"Idle", "Run", "Fault"};
+
+    {
+        auto a = pvtui::intern_choices(on_off);
+        auto b = pvtui::intern_choices(std::vector<std::string>(on_off));
+        auto c = pvtui::intern_choices(modes);
+        assert(a == b);
+        assert(a != c);
+        assert(*c == modes);
+        assert(pvtui::interned_choices_count() == 2);
+        assert(pvtui::intern_choices(std::vector<std::string>()) == pvtui::empty_choices());
+        assert(pvtui::empty_choices()->empty());
+    }
+    // Unused lists are not kept alive by the pool
+    assert(pvtui::interned_choices_count() == 0);
+
+    {
+        pvtui::InternedString a("test:name");
+        pvtui::InternedString b(std::string("test:") + "name");
+        pvtui::InternedString c("test:other");
+        assert(a == b);
+        assert(a != c);
+        assert(&a.str() == &b.str());
+        assert(a == "test:name");
+        assert(pvtui::InternedString::count() == 2);
+        assert(pvtui::InternedString().empty());
+    }
+    assert(pvtui::InternedString::count() == 0);
+
+    // Many short-lived values don't grow the pool without bound
+    for (int i = 0; i < 10000; i++) {
+        pvtui::InternedString temp("test:temp" + std::to_string(i));
+        assert(pvtui::InternedString::count() == 1);
+    }
+
+    // The channels never connect, updates are fed directly with process_update()
+    pvas::StaticProvider server("test");
+    pvac::ClientProvider provider(server.provider());
+    {
+        pvtui::PVGroup group1(provider, {"test:enum"});
+        pvtui::PVGroup group2(provider, {"test:enum"});
+        pvtui::PVHandler& pv1 = group1["test:enum"];
+        pvtui::PVHandler& pv2 = group2["test:enum"];
+        assert(pv1.name == pv2.name);
+        assert(&pv1.name.str() == &pv2.name.str());
+
+        pvtui::PVEnum value1;
+        pvtui::PVEnum value2;
+        pv1.set_monitor(value1);
+        pv2.set_monitor(value2);
+
+        pvd::BitSet changed;
+        changed.set(0);
+        pv1.process_update(*make_enum(modes, 1), changed);
+        pv2.process_update(*make_enum(modes, 1), changed);
+        group1.sync();
+        group2.sync();
+        assert(value1.choice == "Run");
+        assert(*value1.choices == modes);
+        assert(value1.choices == value2.choices);
+
+        // Same choices in a new array: the list is kept, only the index changes
+        const pvtui::ChoiceList first = value1.choices;
+        pv1.process_update(*make_enum(modes, 2), changed);
+        group1.sync();
+        assert(value1.index == 2);
+        assert(value1.choice == "Fault");
+        assert(value1.choices == first);
+
+        // New choices replace the list
+        pv1.process_update(*make_enum(on_off, 0), changed);
+        group1.sync();
+        assert(value1.choice == "Off");
+        assert(*value1.choices == on_off);
+        assert(value1.choices != first);
+    }
+
+    std::cout << "[pvtui::intern] All tests passed" << std::endl;
+}
@@ -0,0 +1,275 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <pv/pvData.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pvtui/decode_pool.hpp>
+#include <pvtui/pvgroup.hpp>
+
+// Registers several variable types on the same PV and checks that one update
+// fills all of them, and that PVGroups share channels. Updates are fed directly
+// with process_update(). Puts go to an in-process mailbox PV.
+
+namespace pvd = epics::pvData;
+
+// Waits up to a second for all puts made to pv to finish
+static pvtui::PutStatus wait_for_puts(pvtui::PVHandler& pv) {
+    pvtui::PutStatus status = pv.put_status();
+    for (int i = 0; i < 100 && status.state == pvtui::PutState::Pending; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        status = pv.put_status();
+    }
+    return status;
+}
+
+int main() {
+
+    auto type = pvd::getFieldCreate()
+                    ->createFieldBuilder()
+                    ->setId("epics:nt/NTScalar:1.0")
+                    ->add("value", pvd::pvDouble)
+                    ->createStructure();
+    auto root = pvd::getPVDataCreate()->createPVStructure(type);
+    auto value = root->getSubFieldT<pvd::PVDouble>("value");
+    pvd::BitSet changed;
+    changed.set(value->getFieldOffset());
+
+    pvas::StaticProvider server("test");
+    auto mailbox = pvas::SharedPV::buildMailbox();
+    mailbox->open(*root);
+    server.add("test:setpoint", mailbox);
+    pvac::ClientProvider provider(server.provider());
+    pvtui::PVHandler pv(provider, "test:rbv");
+
+    // Only the MonitorVar alternatives can be monitored, each through its own typed slot
+    static_assert(pvtui::is_monitor_type_v<double> && pvtui::is_monitor_type_v<pvtui::SharedArray<int>>);
+    static_assert(!pvtui::is_monitor_type_v<float> && !pvtui::is_monitor_type_v<std::monostate>);
+
+    double as_double = 0.0;
+    double as_double2 = 0.0;
+    int as_int = 0;
+    std::string as_string;
+    pv.set_monitor(as_double);
+    pv.set_monitor(as_double2);
+    pv.set_monitor(as_int);
+    pv.set_monitor(as_string);
+
+    value->put(3.25);
+    pv.process_update(*root, changed);
+    assert(pv.sync());
+    assert(as_double == 3.25);
+    assert(as_double2 == 3.25);
+    assert(as_int == 3);
+    assert(as_string == "3.2500");
+    assert(!pv.sync());
+
+    value->put(-7.0);
+    pv.process_update(*root, changed);
+    assert(pv.sync());
+    assert(as_double == -7.0);
+    assert(as_int == -7);
+    assert(as_string == "-7.0000");
+
+    // Monitored<T> carries the alarm and timestamp of the same update as the value
+    {
+        auto alarm_type = pvd::getFieldCreate()
+                              ->createFieldBuilder()
+                              ->setId("epics:nt/NTScalar:1.0")
+                              ->add("value", pvd::pvDouble)
+                              ->addNestedStructure("alarm")
+                              ->add("severity", pvd::pvInt)
+                              ->add("status", pvd::pvInt)
+                              ->add("message", pvd::pvString)
+                              ->endNested()
+                              ->addNestedStructure("timeStamp")
+                              ->add("secondsPastEpoch", pvd::pvLong)
+                              ->add("nanoseconds", pvd::pvInt)
+                              ->add("userTag", pvd::pvInt)
+                              ->endNested()
+                              ->createStructure();
+        auto alarm_root = pvd::getPVDataCreate()->createPVStructure(alarm_type);
+        pvd::BitSet all;
+        all.set(0);
+
+        pvtui::PVHandler alarm_pv(provider, "test:alarm");
+        pvtui::Monitored<double> monitored;
+        double plain = 0.0;
+        alarm_pv.set_monitor(monitored);
+        alarm_pv.set_monitor(plain);
+
+        alarm_root->getSubFieldT<pvd::PVDouble>("value")->put(99.0);
+        alarm_root->getSubFieldT<pvd::PVInt>("alarm.severity")->put(2);
+        alarm_root->getSubFieldT<pvd::PVInt>("alarm.status")->put(3);
+        alarm_root->getSubFieldT<pvd::PVString>("alarm.message")->put("HIHI");
+        alarm_root->getSubFieldT<pvd::PVLong>("timeStamp.secondsPastEpoch")->put(1700000000);
+        alarm_root->getSubFieldT<pvd::PVInt>("timeStamp.nanoseconds")->put(500000000);
+        alarm_pv.process_update(*alarm_root, all);
+        assert(alarm_pv.sync());
+        assert(plain == 99.0);
+        assert(monitored.value == 99.0);
+        assert(monitored.alarm.severity == pvtui::AlarmSeverity::Major);
+        assert(monitored.alarm.status == 3);
+        assert(monitored.alarm.message == "HIHI");
+        assert(monitored.timestamp.seconds == 1700000000);
+        assert(monitored.timestamp.to_double() == 1700000000.5);
+        assert(std::string(pvtui::alarm_severity_name(monitored.alarm.severity)) == "MAJOR");
+
+        // An alarm change without a value change still reaches the monitored variable
+        alarm_root->getSubFieldT<pvd::PVInt>("alarm.severity")->put(0);
+        alarm_root->getSubFieldT<pvd::PVString>("alarm.message")->put("");
+        pvd::BitSet alarm_changed;
+        alarm_changed.set(alarm_root->getSubFieldT<pvd::PVStructure>("alarm")->getFieldOffset());
+        alarm_pv.process_update(*alarm_root, alarm_changed);
+        assert(alarm_pv.sync());
+        assert(monitored.alarm.severity == pvtui::AlarmSeverity::NoAlarm);
+        assert(monitored.alarm.message.empty());
+    }
+
+    // A paused PV keeps its last value and catches up when resumed
+    {
+        auto served = pvas::SharedPV::buildReadOnly();
+        value->put(1.0);
+        served->open(*root);
+        server.add("test:paused", served);
+
+        pvtui::PVHandler paused_pv(provider, "test:paused");
+        paused_pv.add_viewer();
+        paused_pv.add_viewer();
+        double latest = 0.0;
+        paused_pv.set_monitor(latest);
+        for (int i = 0; i < 100 && latest != 1.0; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            paused_pv.sync();
+        }
+        assert(latest == 1.0);
+
+        // Only paused once every viewer is hidden
+        paused_pv.pause();
+        assert(!paused_pv.paused());
+        paused_pv.pause();
+        assert(paused_pv.paused());
+        assert(paused_pv.connected());
+
+        value->put(2.0);
+        served->post(*root, changed);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        paused_pv.sync();
+        assert(latest == 1.0);
+
+        paused_pv.resume();
+        assert(!paused_pv.paused());
+        for (int i = 0; i < 100 && latest != 2.0; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            paused_pv.sync();
+        }
+        assert(latest == 2.0);
+        assert(paused_pv.connected());
+    }
+
+    // Variables and listeners added later start with the newest value, which isn't
+    // sent to the existing listeners or counted again
+    {
+        auto served = pvas::SharedPV::buildReadOnly();
+        value->put(5.0);
+        served->open(*root);
+        server.add("test:seed", served);
+
+        pvtui::PVHandler seed_pv(provider, "test:seed");
+        std::atomic<int> first_calls{0};
+        seed_pv.add_update_listener([&first_calls](const pvtui::PVHandler&, const pvd::PVStructure&) {
+            first_calls++;
+        });
+        for (int i = 0; i < 100 && first_calls == 0; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        assert(first_calls == 1);
+        const uint64_t received = seed_pv.counters().received;
+
+        double seeded = 0.0;
+        seed_pv.set_monitor(seeded);
+        int second_calls = 0;
+        seed_pv.add_update_listener([&second_calls](const pvtui::PVHandler&, const pvd::PVStructure& update) {
+            assert(update.getSubFieldT<pvd::PVDouble>("value")->get() == 5.0);
+            second_calls++;
+        });
+        assert(seed_pv.sync());
+        assert(seeded == 5.0);
+        assert(second_calls == 1);
+        assert(first_calls == 1);
+        assert(seed_pv.counters().received == received);
+    }
+
+    // With a decode pool, updates are coalesced before they are decoded but listeners
+    // still see every one of them
+    {
+        auto pool = std::make_shared<pvtui::DecodePool>(2);
+        pvtui::PVHandler pooled_pv(provider, "test:pooled");
+        double pooled = 0.0;
+        pooled_pv.set_monitor(pooled);
+        pooled_pv.set_decode_pool(pool);
+        std::atomic<int> calls{0};
+        std::atomic<double> last{0.0};
+        pooled_pv.add_update_listener([&](const pvtui::PVHandler&, const pvd::PVStructure& update) {
+            last = update.getSubFieldT<pvd::PVDouble>("value")->get();
+            calls++;
+        });
+
+        constexpr int burst = 1000;
+        for (int i = 1; i <= burst; i++) {
+            value->put(i);
+            pooled_pv.process_update(*root, changed);
+        }
+        pool->wait_idle();
+        assert(calls == burst);
+        assert(last == burst);
+        assert(pooled_pv.sync());
+        assert(pooled == burst);
+        assert(pooled_pv.counters().decoded <= burst);
+    }
+
+    // Groups share one subscription per PV, which closes with the last handler
+    {
+        pvtui::PVGroup group1(provider, {"test:rbv", "test:desc"});
+        pvtui::PVGroup group2(provider, {"test:rbv"});
+        assert(pvtui::SharedChannel::count() == 2);
+        assert(group1["test:rbv"].channel().name() == group2["test:rbv"].channel().name());
+    }
+    assert(pvtui::SharedChannel::count() == 1);
+
+    // Puts don't block, and puts made while one is in flight are coalesced
+    {
+        pvtui::PVHandler setpoint(provider, "test:setpoint");
+        for (int i = 0; i < 100 && !setpoint.connected(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        assert(setpoint.connected());
+        for (int i = 1; i <= 10; i++) {
+            setpoint.put("value", 1.5 * i);
+        }
+        pvtui::PutStatus status = wait_for_puts(setpoint);
+        assert(status.state == pvtui::PutState::Done);
+        assert(status.failed == 0);
+        assert(status.completed + status.coalesced + 1 >= 10);
+
+        double readback = 0.0;
+        setpoint.set_monitor(readback);
+        for (int i = 0; i < 100 && readback != 15.0; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            setpoint.sync();
+        }
+        assert(readback == 15.0);
+
+        setpoint.put("no_such_field", 1);
+        status = wait_for_puts(setpoint);
+        assert(status.state == pvtui::PutState::Failed);
+        assert(status.failed == 1);
+    }
+
+    std::cout << "[pvtui::PVHandler] All multi-type monitor tests passed" << std::endl;
+}
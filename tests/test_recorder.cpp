@@ -0,0 +1,105 @@
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <pv/pvData.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pvtui/pvgroup.hpp>
+#include <pvtui/recorder.hpp>
+
+// Records updates fed with process_update() and checks the CSV and JSON lines
+// written for them, including the server timestamp.
+
+namespace pvd = epics::pvData;
+
+static pvd::PVStructurePtr make_root(pvd::ScalarType value_type) {
+    auto type = pvd::getFieldCreate()
+                    ->createFieldBuilder()
+                    ->setId("epics:nt/NTScalar:1.0")
+                    ->add("value", value_type)
+                    ->addNestedStructure("timeStamp")
+                    ->add("secondsPastEpoch", pvd::pvLong)
+                    ->add("nanoseconds", pvd::pvInt)
+                    ->add("userTag", pvd::pvInt)
+                    ->endNested()
+                    ->createStructure();
+    auto root = pvd::getPVDataCreate()->createPVStructure(type);
+    root->getSubFieldT<pvd::PVLong>("timeStamp.secondsPastEpoch")->put(1700000000);
+    root->getSubFieldT<pvd::PVInt>("timeStamp.nanoseconds")->put(5000);
+    return root;
+}
+
+int main() {
+
+    std::cout << "[pvtui::UpdateRecorder] Running tests...\n";
+
+    assert(pvtui::parse_record_format("csv") == pvtui::RecordFormat::CSV);
+    assert(pvtui::parse_record_format("jsonl") == pvtui::RecordFormat::JSONL);
+    assert(!pvtui::parse_record_format("xml"));
+
+    // The channels never connect, updates are fed directly with process_update()
+    pvas::StaticProvider server("test");
+    pvac::ClientProvider provider(server.provider());
+    pvtui::PVHandler number_pv(provider, "test:number");
+    pvtui::PVHandler string_pv(provider, "test:string");
+
+    auto number = make_root(pvd::pvDouble);
+    auto string = make_root(pvd::pvString);
+    pvd::BitSet changed;
+    changed.set(0);
+
+    {
+        std::ostringstream out;
+        pvtui::UpdateRecorder recorder(out, pvtui::RecordFormat::CSV);
+        recorder.attach(number_pv);
+        recorder.attach(string_pv);
+
+        // Every update is recorded, not just the newest at sync()
+        number->getSubFieldT<pvd::PVDouble>("value")->put(1.5);
+        number_pv.process_update(*number, changed);
+        number->getSubFieldT<pvd::PVDouble>("value")->put(2.5);
+        number_pv.process_update(*number, changed);
+        string->getSubFieldT<pvd::PVString>("value")->put("a,\"b\"");
+        string_pv.process_update(*string, changed);
+        assert(recorder.records() == 3);
+
+        // Nothing is written until the buffer fills or flush() is called
+        assert(out.str().empty());
+        recorder.flush();
+        assert(out.str() == "timestamp,pv,value\n"
+                            "1700000000.000005000,test:number,1.5\n"
+                            "1700000000.000005000,test:number,2.5\n"
+                            "1700000000.000005000,test:string,\"a,\"\"b\"\"\"\n");
+    }
+
+    {
+        // The recorder has detached, so these are not recorded anywhere
+        number_pv.process_update(*number, changed);
+
+        std::ostringstream out;
+        pvtui::UpdateRecorder recorder(out, pvtui::RecordFormat::JSONL);
+        recorder.attach(number_pv);
+        number->getSubFieldT<pvd::PVDouble>("value")->put(-0.25);
+        number_pv.process_update(*number, changed);
+        string->getSubFieldT<pvd::PVString>("value")->put("line\nbreak");
+        recorder.record("test:other", *string);
+        recorder.flush();
+        assert(out.str() == "{\"timestamp\":1700000000.000005000,\"pv\":\"test:number\",\"value\":-0.25}\n"
+                            "{\"timestamp\":1700000000.000005000,\"pv\":\"test:other\",\"value\":\"line\\nbreak\"}\n");
+    }
+
+    {
+        // A full buffer is written right away
+        std::ostringstream out;
+        pvtui::UpdateRecorder recorder(out, pvtui::RecordFormat::JSONL, 64);
+        recorder.attach(number_pv);
+        for (int i = 0; i < 4; i++) {
+            number_pv.process_update(*number, changed);
+        }
+        assert(!out.str().empty());
+    }
+
+    std::cout << "[pvtui::UpdateRecorder] All tests passed" << std::endl;
+}
@@ -0,0 +1,117 @@
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <pv/pvData.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pvtui/pvgroup.hpp>
+
+// Stress tests for tearing: a writer thread publishes values whose elements are all
+// equal while the reader checks that it never sees a mix of two values, and that
+// values never go backwards.
+
+namespace pvd = epics::pvData;
+
+constexpr uint64_t NUM_WRITES = 1000000;
+constexpr uint64_t NUM_UPDATES = 100000;
+constexpr size_t ARRAY_SIZE = 256;
+
+static bool all_equal(const std::array<uint64_t, ARRAY_SIZE>& values) {
+    for (uint64_t v : values) {
+        if (v != values[0]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+
+    std::cout << "[pvtui::TripleBuffer] Running tearing stress tests...\n";
+
+    {
+        pvtui::TripleBuffer<std::array<uint64_t, ARRAY_SIZE>> buffer;
+        buffer.initialize([](auto& values) { values.fill(0); });
+
+        std::thread writer([&buffer] {
+            for (uint64_t i = 1; i <= NUM_WRITES; i++) {
+                buffer.write_buffer().fill(i);
+                buffer.publish();
+            }
+        });
+
+        uint64_t last = 0;
+        uint64_t reads = 0;
+        while (last < NUM_WRITES) {
+            if (buffer.update()) {
+                const auto& values = buffer.read_buffer();
+                assert(all_equal(values));
+                assert(values[0] > last);
+                last = values[0];
+                reads++;
+            }
+        }
+        writer.join();
+        assert(!buffer.update());
+        std::cout << "  TripleBuffer: " << reads << " of " << NUM_WRITES << " values read, no tearing\n";
+    }
+
+    {
+        // The same through PVHandler, decoding on one thread and syncing on another
+        auto type = pvd::getFieldCreate()
+                        ->createFieldBuilder()
+                        ->setId("epics:nt/NTScalarArray:1.0")
+                        ->addArray("value", pvd::pvDouble)
+                        ->createStructure();
+        auto root = pvd::getPVDataCreate()->createPVStructure(type);
+        auto value = root->getSubFieldT<pvd::PVDoubleArray>("value");
+        pvd::BitSet changed;
+        changed.set(value->getFieldOffset());
+
+        pvas::StaticProvider server("test");
+        pvac::ClientProvider provider(server.provider());
+        pvtui::PVHandler pv(provider, "test:array");
+        std::vector<double> var;
+        pv.set_monitor(var);
+        pv.sync(); // the initial connection state
+
+        // sync() only returns true when it copied a new value, even if the flag set for
+        // a value it already took arrives late
+        std::atomic<bool> done{false};
+        std::thread writer([&] {
+            for (uint64_t i = 1; i <= NUM_UPDATES; i++) {
+                pvd::shared_vector<double> vals(ARRAY_SIZE, static_cast<double>(i));
+                value->replace(pvd::freeze(vals));
+                pv.process_update(*root, changed);
+            }
+            done = true;
+        });
+
+        double last = 0.0;
+        uint64_t syncs = 0;
+        while (true) {
+            const bool finished = done;
+            if (pv.sync()) {
+                assert(var.size() == ARRAY_SIZE);
+                for (double v : var) {
+                    assert(v == var[0]);
+                }
+                assert(var[0] > last);
+                last = var[0];
+                syncs++;
+            } else if (finished) {
+                break;
+            }
+        }
+        writer.join();
+        assert(var[0] == static_cast<double>(NUM_UPDATES));
+        std::cout << "  PVHandler: " << syncs << " of " << NUM_UPDATES << " updates synced, no tearing\n";
+    }
+
+    std::cout << "[pvtui::TripleBuffer] All tearing stress tests passed" << std::endl;
+}
@@ -0,0 +1,102 @@
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include <ftxui/component/event.hpp>
+#include <ftxui/dom/elements.hpp>
+#include <ftxui/dom/node.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <pv/pvData.h>
+#include <pva/client.h>
+#include <pva/server.h>
+#include <pva/sharedstate.h>
+#include <pvtui/pvtui.hpp>
+
+// Clicks a button and selects a choice on read-only in-process PVs, and checks that
+// the failed puts are shown on the widgets.
+
+namespace pvd = epics::pvData;
+
+// Waits up to a second for the puts made to pv to finish
+static pvtui::PutStatus wait_for_puts(pvtui::PVHandler& pv) {
+    pvtui::PutStatus status = pv.put_status();
+    for (int i = 0; i < 100 && status.state != pvtui::PutState::Done && status.state != pvtui::PutState::Failed;
+         i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        status = pv.put_status();
+    }
+    return status;
+}
+
+// Renders a widget on one line and checks if any cell has a red background
+static bool shows_failure(const ftxui::Component& component) {
+    auto screen = ftxui::Screen::Create(ftxui::Dimension::Fixed(20), ftxui::Dimension::Fixed(1));
+    ftxui::Render(screen, component->Render());
+    for (int x = 0; x < screen.dimx(); x++) {
+        if (screen.PixelAt(x, 0).background_color == ftxui::Color::Red) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main() {
+
+    std::cout << "[pvtui widgets] Running tests...\n";
+
+    auto proc_type = pvd::getFieldCreate()
+                         ->createFieldBuilder()
+                         ->setId("epics:nt/NTScalar:1.0")
+                         ->add("value", pvd::pvInt)
+                         ->createStructure();
+    auto proc_root = pvd::getPVDataCreate()->createPVStructure(proc_type);
+
+    auto mode_type = pvd::getFieldCreate()
+                         ->createFieldBuilder()
+                         ->setId("epics:nt/NTEnum:1.0")
+                         ->addNestedStructure("value")
+                         ->add("index", pvd::pvInt)
+                         ->addArray("choices", pvd::pvString)
+                         ->endNested()
+                         ->createStructure();
+    auto mode_root = pvd::getPVDataCreate()->createPVStructure(mode_type);
+    pvd::shared_vector<std::string> choices(2);
+    choices[0] = "Off";
+    choices[1] = "On";
+    mode_root->getSubFieldT<pvd::PVStringArray>("value.choices")->replace(pvd::freeze(choices));
+
+    // Read-only PVs fail every put
+    pvas::StaticProvider server("test");
+    auto proc = pvas::SharedPV::buildReadOnly();
+    proc->open(*proc_root);
+    server.add("test:proc", proc);
+    auto mode = pvas::SharedPV::buildReadOnly();
+    mode->open(*mode_root);
+    server.add("test:mode", mode);
+    pvac::ClientProvider provider(server.provider());
+
+    pvtui::PVGroup group(provider);
+    pvtui::ButtonWidget button(group, "test:proc", " + ");
+    pvtui::ChoiceWidget choice(group, "test:mode", pvtui::ChoiceStyle::Horizontal);
+    for (int i = 0; i < 100 && (!button.connected() || choice.value().choices->size() != 2); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        group.sync();
+    }
+    assert(button.connected());
+    assert(choice.value().choices->size() == 2);
+    assert(!shows_failure(button.component()));
+    assert(!shows_failure(choice.component()));
+
+    button.component()->OnEvent(ftxui::Event::Return);
+    assert(wait_for_puts(group.get_pv("test:proc")).state == pvtui::PutState::Failed);
+    assert(shows_failure(button.component()));
+    std::cout << "[pvtui widgets] Button shows a failed put\n";
+
+    choice.component()->OnEvent(ftxui::Event::ArrowRight);
+    assert(wait_for_puts(group.get_pv("test:mode")).state == pvtui::PutState::Failed);
+    assert(shows_failure(choice.component()));
+    std::cout << "[pvtui widgets] Choice shows a failed put\n";
+
+    std::cout << "[pvtui widgets] All tests passed!" << std::endl;
+}